@@ -0,0 +1,35 @@
+#include <cstdlib>
+#include <new>
+#include "Metrics.hpp"
+
+/* --- Counting global allocator ---
+ * Replaces operator new and delete of the whole program, so it is linked into the executables only
+ * and never into decision_core: programs using the C API keep their own allocator.
+ */
+void *operator new(std::size_t size)
+{
+    countAllocation(size);
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+void *operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
@@ -1,7 +1,10 @@
-#include <fstream>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 #include "CSVManager.hpp"
 #include "preprocessing.hpp"
+#include "Metrics.hpp"
 
 #define DELIMITER ",\n"
 
@@ -10,55 +13,88 @@
 #define COLUMN_SEMGROUP 1
 #define COLUMN_POINTS 2
 
+#define LINE_ARENA_SIZE 1024
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+/**
+ * @brief Continues FNV-1a hash <hash> with the given bytes
+ *
+ * @param hash hash so far
+ * @param data bytes to add
+ * @param size number of bytes
+ * @return uint64_t
+ */
+static uint64_t hashBytes(uint64_t hash, const char *data, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
 /**
- * @brief Creates a new Student object from csvLine
+ * @brief Appends the student of csvLine to <students>
  *
+ * @param students roster to append to
  * @param csvLine string in csv-format with student information
  * @param size length of csvLine
+ * @param lineArena memory for temporaries of parsing the line
  */
-Student CSVManager::createStudentFromCSV(char *csvLine, size_t size)
+void CSVManager::appendStudentFromCSV(CompactRoster &students, char *csvLine, size_t size, std::pmr::memory_resource *lineArena)
 {
-    char *funcArg = new char[size];             // stores argument for exception-handling because argument will be altered
-    copy(csvLine, csvLine + size + 1, funcArg); // deep copy of function argument (+1 for copying string-end aka \0)
+    // stores argument for exception-handling because argument will be altered
+    std::pmr::string funcArg(csvLine, size, lineArena);
 
     const char *delimiter = DELIMITER;
-    vector<string> tokens = separateLine(csvLine, delimiter);
+    std::pmr::vector<std::string_view> tokens = separateLine(csvLine, delimiter, lineArena);
     try
     {
-        return Student(
-            tokens.at(COLUMN_NAME),                 // name
-            tokens.at(COLUMN_SEMGROUP),             // seminar group
-            (uint8_t)stoi(tokens.at(COLUMN_POINTS)) // points
+        students.append(
+            tokens.at(COLUMN_NAME),                              // name
+            tokens.at(COLUMN_SEMGROUP),                          // seminar group
+            (uint8_t)stoi(std::string(tokens.at(COLUMN_POINTS))) // points
         );
     }
     catch (std::out_of_range &exc)
     {
-        cerr << "Error:\t" << exc.what()
+        std::cerr << "Error:\t" << exc.what()
              << "\tat creating Student-Obj with:\n\t\""
-             << funcArg << "\"" << endl;
+             << funcArg << "\"" << std::endl;
         throw;
     }
     catch (std::invalid_argument &excia)
     {
-        cerr << "Error:\t" << excia.what()
+        std::cerr << "Error:\t" << excia.what()
              << "\tat creating Student-Obj with invalid arg for points:\n\t\""
-             << funcArg << "\"" << endl;
+             << funcArg << "\"" << std::endl;
+        throw;
+    }
+    catch (std::length_error &excle)
+    {
+        std::cerr << "Error:\t" << excle.what()
+             << "\tat creating Student-Obj with:\n\t\""
+             << funcArg << "\"" << std::endl;
         throw;
     }
 }
 
 /**
- * @brief Creates string in csv-format from Student obj
+ * @brief Creates string in csv-format from student at position <index> with <points>
  *
- * @param stud Student object for csv-line
+ * @param index position of student in roster
+ * @param points points of the student
  * @return string
  */
-std::string CSVManager::createCSVFromStudent(Student stud)
+std::string CSVManager::createCSVLine(uint32_t index, uint8_t points) const
 {
     std::string csvColumn[COLUMN_COUNT]; // fill array with column information
-    csvColumn[COLUMN_NAME] = stud.getName();
-    csvColumn[COLUMN_SEMGROUP] = stud.getSemGroup();
-    csvColumn[COLUMN_POINTS] = stud.getPointsAsStr();
+    csvColumn[COLUMN_NAME] = table.getName(index);
+    csvColumn[COLUMN_SEMGROUP] = table.getSemGroup(index);
+    csvColumn[COLUMN_POINTS] = std::to_string(points);
 
     // create string
     std::string str = "";
@@ -79,38 +115,92 @@ std::string CSVManager::createCSVFromStudent(Student stud)
 }
 
 /**
- * @brief Reads the given CSV-file and returns list of students
+ * @brief Parses the content of a CSV-file and returns list of students. Updates the roster version to
+ * the hash of the content and the layout hash to the hash of names and seminar groups. Lines are parsed in place; temporaries of parsing a line are placed in an
+ * arena that is reset for every line.
  *
- * @param filename name of csv-file
- * @return vector<Student>
+ * @param content content of csv-file (altered)
+ * @return CompactRoster
  */
-std::vector<Student> CSVManager::readCSV(std::string filename)
+CompactRoster CSVManager::parseCSV(std::string &content)
 {
-    std::vector<Student> studVec;
-    std::ifstream csvStream(filename); // open stream
-    std::string line;
-    while (getline(csvStream, line))
+    CompactRoster studVec;
+    // upper bounds: a line per student, names shorter than their line
+    studVec.reserve(std::count(content.begin(), content.end(), '\n') + 1, content.size());
+    uint64_t hash = FNV_OFFSET_BASIS;
+    uint64_t layout = FNV_OFFSET_BASIS;
+    std::byte lineBuffer[LINE_ARENA_SIZE];
+    std::pmr::monotonic_buffer_resource lineArena(lineBuffer, sizeof(lineBuffer));
+    size_t lineStart = 0;
+    while (lineStart < content.size())
     {
-        studVec.push_back(
-            createStudentFromCSV((char *)line.c_str(), line.length()));
+        size_t lineEnd = content.find('\n', lineStart);
+        if (lineEnd == std::string::npos)
+            lineEnd = content.size(); // last line without newline
+        content[lineEnd] = '\0';      // string-end instead of newline (or the string-end itself)
+        char *line = &content[lineStart];
+        size_t length = lineEnd - lineStart;
+        hash = hashBytes(hash, line, length + 1); // include string-end as line separator
+        appendStudentFromCSV(studVec, line, length, &lineArena);
+        uint32_t stud = studVec.getStudentCount() - 1;
+        std::string_view name = studVec.getName(stud);
+        std::string const &semGroup = studVec.getSemGroup(stud);
+        layout = hashBytes(hashBytes(layout, name.data(), name.size()), "", 1);
+        layout = hashBytes(layout, semGroup.c_str(), semGroup.size() + 1);
+        lineArena.release();
+        lineStart = lineEnd + 1;
     }
-    csvStream.close(); // close stream
+    this->version = hash;
+    this->layoutHash = layout;
+    this->pointsChanged = false;
     return studVec;
 }
 
 /**
- * @brief Replaces current list of students with list in csv
+ * @brief Writes the students of the roster with points column <points> (in roster order) to file
+ * <filename> and sets <version> to the hash of the written content. <version> is unchanged when the
+ * file could not be written. The file is written with one request chain including fsync.
  *
  * @param filename name of resulting file
+ * @param points points per roster position
+ * @param version receives the roster version of the written content
+ * @return bool file was written
  */
-void CSVManager::writeCSV(std::string filename)
+bool CSVManager::writeCSV(std::string const &filename, uint8_t const *points, uint64_t &version) const
 {
-    std::ofstream csvStream(filename); // open stream
-    for (size_t i = 0; i < this->students.size(); i++)
+    ScopedPhaseTimer timer(phaseCSVWrite);
+    std::string content;
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (uint32_t i = 0; i < table.getStudentCount(); i++)
     {
-        csvStream << createCSVFromStudent(this->students.at(i));
+        std::string line = createCSVLine(i, points[i]);
+        content.append(line);
+        line.back() = '\0'; // hash like read lines: newline replaced by string-end
+        hash = hashBytes(hash, line.c_str(), line.length());
     }
-    csvStream.close(); // close stream
+    if (!writeFile(filename, content))
+    {
+        std::cerr << "Error:\t" << "Could not write file \"" << filename << "\": " << strerror(errno) << std::endl;
+        return false;
+    }
+    addPhaseIOBytes(phaseCSVWrite, content.size());
+    version = hash;
+    return true;
+}
+
+/**
+ * @brief Replaces current list of students with list in csv. Updates the roster version to the hash
+ * of the written content when the file was written; otherwise the points stay unsaved.
+ *
+ * @param filename name of resulting file
+ * @return bool file was written
+ */
+bool CSVManager::writeCSV(std::string const &filename)
+{
+    if (!writeCSV(filename, table.getPointsColumn().data(), this->version))
+        return false; // version and unsaved points stay those of the file on disk
+    this->pointsChanged = false;
+    return true;
 }
 
 /**
@@ -120,21 +210,14 @@ void CSVManager::writeCSV(std::string filename)
  * @param name name of student
  * @param doIncrement when true increments by 1; otherwise decrements by 1
  */
-void CSVManager::changePoints(string name, bool doIncrement)
+void CSVManager::changePoints(std::string const &name, bool doIncrement)
 {
-    Student *stud = getStudent(name);
-    if (stud != nullptr)
+    uint32_t stud = getStudentIndex(name);
+    if (stud != NO_STUDENT)
     {
-        if (doIncrement)
-        {
-            stud->incrementPoints();
-        }
-        else
-        {
-            stud->decrementPoints();
-        }
+        adjustPoints(stud, doIncrement);
         writeCSV(this->filename);
-        std::cout << name << " has now " << stud->getPointsAsStr() << " points" << std::endl;
+        std::cout << name << " has now " << std::to_string(table.getPoints(stud)) << " points\n";
     }
     else
     {
@@ -142,31 +225,375 @@ void CSVManager::changePoints(string name, bool doIncrement)
     }
 }
 
-CSVManager::CSVManager(std::string filename)
+CSVManager::CSVManager(std::string const &filename) : CSVManager(filename, readFile(filename))
+{
+}
+
+/**
+ * @brief Roster of CSV-file <filename> with already read content <file>. A missing file is an empty
+ * roster.
+ *
+ * @param filename name of csv-file
+ * @param file content of csv-file
+ */
+CSVManager::CSVManager(std::string const &filename, FileContent file)
 {
+    ScopedPhaseTimer timer(phaseCSVLoad);
+    addPhaseIOBytes(phaseCSVLoad, file.content.size());
     this->filename = filename;
-    this->students = readCSV(filename);
+    this->table = parseCSV(file.content);
+    buildNameIndex();
+    buildCohortIndex();
+}
+
+/**
+ * @brief Loads the rosters of several CSV-files. The files are read concurrently.
+ *
+ * @param filenames names of csv-files
+ * @return std::vector<CSVManager>
+ */
+std::vector<CSVManager> CSVManager::loadRosters(std::vector<std::string> const &filenames)
+{
+    std::vector<FileContent> files = readFiles(filenames);
+    std::vector<CSVManager> rosters;
+    rosters.reserve(filenames.size());
+    for (size_t i = 0; i < filenames.size(); i++)
+        rosters.push_back(CSVManager(filenames[i], std::move(files[i])));
+    return rosters;
+}
+
+/**
+ * @brief Maps the name of every student on its position in the roster: open addressing with linear
+ * probing over a power of two of slots, at most half of them used.
+ * For duplicate names the first student is kept.
+ *
+ */
+void CSVManager::buildNameIndex()
+{
+    size_t slotCount = 2;
+    while (slotCount < 2 * table.getStudentCount())
+        slotCount *= 2;
+    nameSlots.assign(slotCount, NO_STUDENT);
+    for (uint32_t i = 0; i < table.getStudentCount(); i++)
+    {
+        std::string_view name = table.getName(i);
+        size_t slot = std::hash<std::string_view>{}(name) & (slotCount - 1);
+        while (nameSlots[slot] != NO_STUDENT && table.getName(nameSlots[slot]) != name)
+            slot = (slot + 1) & (slotCount - 1);
+        if (nameSlots[slot] == NO_STUDENT)
+            nameSlots[slot] = i;
+    }
+}
+
+/**
+ * @brief Adds student at position <index> to the name slots, unless a student before it has the
+ * same name (the first of duplicate names is found)
+ *
+ * @param index position of student in roster
+ */
+void CSVManager::indexName(uint32_t index)
+{
+    std::string_view name = table.getName(index);
+    size_t mask = nameSlots.size() - 1;
+    size_t slot = std::hash<std::string_view>{}(name) & mask;
+    while (nameSlots[slot] != NO_STUDENT && table.getName(nameSlots[slot]) != name)
+        slot = (slot + 1) & mask;
+    if (nameSlots[slot] == NO_STUDENT || nameSlots[slot] > index)
+        nameSlots[slot] = index;
+}
+
+/**
+ * @brief Removes student at position <index> from the name slots. Entries behind it are shifted
+ * back, so lookups need no tombstones. Returns false when the student had no slot (a duplicate name).
+ *
+ * @param index position of student in roster
+ * @return bool
+ */
+bool CSVManager::unindexName(uint32_t index)
+{
+    size_t mask = nameSlots.size() - 1;
+    size_t hole = std::hash<std::string_view>{}(table.getName(index)) & mask;
+    while (nameSlots[hole] != index)
+    {
+        if (nameSlots[hole] == NO_STUDENT)
+            return false;
+        hole = (hole + 1) & mask;
+    }
+    nameSlots[hole] = NO_STUDENT;
+    for (size_t slot = (hole + 1) & mask; nameSlots[slot] != NO_STUDENT; slot = (slot + 1) & mask)
+    {
+        size_t home = std::hash<std::string_view>{}(table.getName(nameSlots[slot])) & mask;
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) // hole lies on the probe path of the entry
+        {
+            nameSlots[hole] = nameSlots[slot];
+            nameSlots[slot] = NO_STUDENT;
+            hole = slot;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Indexes the students by seminar group and cohort year. Warns once about seminar groups not
+ * in format XYINB-Z; such students are never recognized as repeaters or members of a seminar group.
+ *
+ */
+void CSVManager::buildCohortIndex()
+{
+    groupIndex.clear();
+    for (auto &yearMembers : yearIndex)
+        yearMembers.clear();
+    uint32_t invalid = 0;
+    uint32_t example = NO_STUDENT;
+    for (uint32_t i = 0; i < table.getStudentCount(); i++)
+    {
+        if (!indexCohort(i, table.getCohortKey(i)) && invalid++ == 0)
+            example = i;
+    }
+    warnInvalidGroups(invalid, example);
+}
+
+/**
+ * @brief Adds the position <index> with parsed seminar group <key> to the group and year index
+ * (kept in roster order). Returns false when the seminar group is not in format XYINB-Z and the
+ * student was not indexed.
+ *
+ * @param index position of student in roster
+ * @param key parsed seminar group of the student
+ * @return bool
+ */
+bool CSVManager::indexCohort(uint32_t index, CohortKey key)
+{
+    if (key == INVALID_COHORT)
+        return false;
+    for (std::vector<uint32_t> *members : {&groupIndex[key], &yearIndex[cohortYear(key)]})
+        members->insert(std::lower_bound(members->begin(), members->end(), index), index);
+    return true;
+}
+
+/**
+ * @brief Warns with one line about <count> students with seminar groups not in format XYINB-Z,
+ * naming the student at position <example>. Nothing is printed for <count> 0.
+ *
+ * @param count number of students with invalid seminar group
+ * @param example position of the first of them
+ */
+void CSVManager::warnInvalidGroups(uint32_t count, uint32_t example) const
+{
+    if (count == 0)
+        return;
+    std::cerr << "Warning:\t" << count << (count == 1 ? " student" : " students") << " of \"" << filename
+              << "\" with invalid seminar group (expected format XYINB-Z), e.g. \"" << table.getSemGroup(example)
+              << "\" of student \"" << table.getName(example) << "\"\n";
+}
+
+/**
+ * @brief Removes the position <index> with parsed seminar group <key> from the group and year index
+ *
+ * @param index position of student in roster
+ * @param key parsed seminar group the student was indexed with
+ */
+void CSVManager::unindexCohort(uint32_t index, CohortKey key)
+{
+    if (key == INVALID_COHORT)
+        return;
+    for (std::vector<uint32_t> *members : {&groupIndex[key], &yearIndex[cohortYear(key)]})
+    {
+        auto it = std::lower_bound(members->begin(), members->end(), index);
+        if (it != members->end() && *it == index)
+            members->erase(it);
+    }
+    if (groupIndex[key].empty())
+        groupIndex.erase(key);
+}
+
+/**
+ * @brief Re-reads the CSV-file and applies the differences to the roster: rows are compared by
+ * position and only the columns and index entries of changed, added or removed rows are updated.
+ * Nothing happens when the content hash equals the roster version. The roster is kept as it is when
+ * the file is missing (e.g. while it is replaced) or cannot be parsed, and when the file changed
+ * while points in memory are unsaved (reported as conflict).
+ *
+ * @return RosterDiff
+ */
+RosterDiff CSVManager::reloadChanges()
+{
+    RosterDiff diff;
+    FileContent file = readFile(this->filename);
+    if (!file.found)
+        return diff;
+    uint64_t previousVersion = this->version;
+    uint64_t previousLayoutHash = this->layoutHash;
+    bool previousPointsChanged = this->pointsChanged;
+    CompactRoster fresh;
+    try
+    {
+        fresh = parseCSV(file.content); // updates version and layout hash only when parsed
+    }
+    catch (std::exception const &)
+    {
+        std::cerr << "Error:\t" << "Kept roster of \"" << filename << "\", its file could not be parsed" << std::endl;
+        return diff;
+    }
+    if (this->version == previousVersion || previousPointsChanged)
+    {
+        diff.conflict = this->version != previousVersion;
+        if (diff.conflict)
+            std::cerr << "Error:\t" << "Kept roster of \"" << filename << "\", its file changed while points are unsaved" << std::endl;
+        this->version = previousVersion;
+        this->layoutHash = previousLayoutHash;
+        this->pointsChanged = previousPointsChanged; // points in memory are kept
+        return diff;
+    }
+
+    // unindex changed and removed rows while the index entries still match the old columns
+    size_t common = std::min(table.getStudentCount(), fresh.getStudentCount());
+    std::vector<uint32_t> renamed, regrouped;
+    std::vector<std::string> freedNames; // old names whose first student was unindexed
+    for (uint32_t i = 0; i < table.getStudentCount(); i++)
+    {
+        bool removed = i >= common;
+        bool nameChanged = removed || table.getName(i) != fresh.getName(i);
+        bool groupChanged = removed || table.getSemGroup(i) != fresh.getSemGroup(i);
+        if (removed)
+            diff.removed++;
+        else if (nameChanged || groupChanged || table.getPoints(i) != fresh.getPoints(i))
+            diff.changed++;
+        if (nameChanged && unindexName(i))
+            freedNames.emplace_back(table.getName(i));
+        if (nameChanged && !removed)
+            renamed.push_back(i);
+        if (groupChanged)
+            unindexCohort(i, table.getCohortKey(i));
+        if (groupChanged && !removed)
+            regrouped.push_back(i);
+    }
+
+    // apply the rows to the columns
+    try
+    {
+        table.truncate(common);
+        for (uint32_t i = 0; i < common; i++)
+            table.setPoints(i, fresh.getPoints(i));
+        for (uint32_t i : renamed)
+            table.setName(i, fresh.getName(i));
+        for (uint32_t i : regrouped)
+            table.setSemGroup(i, fresh.getSemGroup(i));
+        for (uint32_t i = common; i < fresh.getStudentCount(); i++)
+            table.append(fresh.getName(i), fresh.getSemGroup(i), fresh.getPoints(i));
+    }
+    catch (std::length_error const &)
+    {
+        // dictionary full of groups no longer used: take the parsed roster as a whole
+        table = std::move(fresh);
+        buildNameIndex();
+        buildCohortIndex();
+        std::atomic_store(&similarNames, std::shared_ptr<NameIndex const>());
+        diff.added = table.getStudentCount() - common;
+        return diff;
+    }
+    diff.added = table.getStudentCount() - common;
+
+    // index the changed and added rows
+    uint32_t invalid = 0;
+    uint32_t example = NO_STUDENT;
+    for (uint32_t i : regrouped)
+    {
+        if (!indexCohort(i, table.getCohortKey(i)) && invalid++ == 0)
+            example = i;
+    }
+    for (uint32_t i = common; i < table.getStudentCount(); i++)
+    {
+        if (!indexCohort(i, table.getCohortKey(i)) && invalid++ == 0)
+            example = i;
+    }
+    warnInvalidGroups(invalid, example); // only changed and added students, the others were reported before
+    if (2 * table.getStudentCount() > nameSlots.size())
+        buildNameIndex(); // grown beyond the load of the slots
+    else
+    {
+        for (uint32_t i : renamed)
+            indexName(i);
+        for (uint32_t i = common; i < table.getStudentCount(); i++)
+            indexName(i);
+        // the first remaining student with a freed name takes its slot, even over a renamed or added one
+        for (std::string const &name : freedNames)
+        {
+            uint32_t i = 0;
+            while (i < table.getStudentCount() && table.getName(i) != name)
+                i++;
+            if (i < table.getStudentCount())
+                indexName(i);
+        }
+    }
+    if (!renamed.empty() || diff.added > 0 || diff.removed > 0)
+        std::atomic_store(&similarNames, std::shared_ptr<NameIndex const>());
+    return diff;
+}
+
+/**
+ * @brief Returns positions of all students of seminar group <group> (XYINB-Z) or of all students of
+ * cohort year <group> (XY) in roster order. Returns empty list when the group has no students or is
+ * not valid.
+ *
+ * @param group seminar group or cohort year
+ * @return std::vector<uint32_t> const&
+ */
+std::vector<uint32_t> const &CSVManager::getGroupMembers(std::string const &group) const
+{
+    static const std::vector<uint32_t> noMembers;
+    int year = parseCohortYear(group);
+    if (year != INVALID_YEAR)
+        return yearIndex[year];
+    auto it = groupIndex.find(parseCohortKey(group));
+    return it != groupIndex.end() ? it->second : noMembers;
+}
+
+/**
+ * @brief Returns position of student with matching name in the roster.
+ * Returns NO_STUDENT when no matching student found.
+ *
+ * @param name name of student to search for
+ * @return uint32_t
+ */
+uint32_t CSVManager::getStudentIndex(std::string_view name) const
+{
+    size_t mask = nameSlots.size() - 1;
+    for (size_t slot = std::hash<std::string_view>{}(name) & mask; nameSlots[slot] != NO_STUDENT; slot = (slot + 1) & mask)
+    {
+        if (table.getName(nameSlots[slot]) == name)
+            return nameSlots[slot];
+    }
+    return NO_STUDENT;
 }
 
 /**
- * @brief Returns reference to Student-Obj with matching name.
- * Returns nullptr when no matching student found.
+ * @brief Returns up to <maxMatches> students with names similar to <name>, most similar first.
+ * Builds the trigram index of the names on the first call, so rosters only looked up by exact names
+ * never pay for it. Of duplicate names only the first student is indexed. Safe to call from several
+ * threads: the index is published atomically (threads racing on the first call may each build it).
  *
  * @param name name of student to search for
- * @return Student*
+ * @param maxMatches maximal number of matches
+ * @return std::vector<NameMatch>
  */
-Student *CSVManager::getStudent(string name)
+std::vector<NameMatch> CSVManager::findSimilarNames(std::string const &name, size_t maxMatches) const
 {
-    size_t i = 0;
-    while (i < students.size())
+    std::shared_ptr<NameIndex const> index = std::atomic_load(&similarNames);
+    if (!index)
     {
-        if (this->students.at(i).getName() == name)
+        std::vector<std::string_view> names(table.getStudentCount()); // first student per name only
+        for (uint32_t slot : nameSlots)
         {
-            return &students.at(i);
+            if (slot != NO_STUDENT)
+                names[slot] = table.getName(slot);
         }
-        ++i;
+        auto built = std::make_shared<NameIndex>();
+        built->build(names);
+        index = built;
+        std::atomic_store(&similarNames, index);
     }
-    return nullptr;
+    return index->findSimilar(name, maxMatches);
 }
 
 /**
@@ -174,7 +601,7 @@ Student *CSVManager::getStudent(string name)
  *
  * @param name name of student
  */
-void CSVManager::incrementPoints(string name)
+void CSVManager::incrementPoints(std::string const &name)
 {
     changePoints(name, true);
 }
@@ -184,7 +611,98 @@ void CSVManager::incrementPoints(string name)
  *
  * @param name name of student
  */
-void CSVManager::decrementPoints(string name)
+void CSVManager::decrementPoints(std::string const &name)
 {
     changePoints(name, false);
 }
+
+/**
+ * @brief Increments or decrements points of student at position <index> of the roster without
+ * writing the CSV file. Changes are persisted by saveChanges.
+ *
+ * @param index position of student in roster
+ * @param doIncrement increment when true, decrement otherwise
+ */
+void CSVManager::adjustPoints(uint32_t index, bool doIncrement)
+{
+    uint8_t points = table.getPoints(index);
+    if (doIncrement)
+        table.setPoints(index, points + 1);
+    else if (points > 0)
+        table.setPoints(index, points - 1);
+    else
+        std::cout << "Warning: student " << table.getName(index) << " has no points to lose (already 0 points)" << std::endl;
+    pointsChanged = true;
+}
+
+/**
+ * @brief Writes the roster with points column <points> (in roster order, e.g. of a snapshot) to its
+ * CSV file without changing the roster. Sets <version> to the roster version of the written content.
+ *
+ * @param points points per roster position
+ * @param version receives the roster version of the written content
+ * @return bool file was written
+ */
+bool CSVManager::savePointsColumn(std::vector<uint8_t> const &points, uint64_t &version) const
+{
+    return writeCSV(this->filename, points.data(), version);
+}
+
+/**
+ * @brief Writes all changes of points to the CSV file at once
+ *
+ * @return bool file was written
+ */
+bool CSVManager::saveChanges()
+{
+    return writeCSV(this->filename);
+}
+
+/**
+ * @brief Returns the version of the roster. It is the hash of the file content as last read or
+ * written, so it changes with every change of points.
+ *
+ * @return uint64_t
+ */
+uint64_t CSVManager::getVersion() const
+{
+    return this->version;
+}
+
+/**
+ * @brief Returns bytes of the heap block of <str>, 0 when the string is stored inside the object
+ * (short string optimization)
+ *
+ * @param str string
+ * @return size_t
+ */
+size_t stringHeapBytes(std::string const &str)
+{
+    const char *inside = reinterpret_cast<const char *>(&str);
+    if (str.data() >= inside && str.data() < inside + sizeof(str))
+        return 0;
+    return str.capacity() + 1;
+}
+
+/**
+ * @brief Returns the memory used by the students and the indexes of the roster. Nodes of hash maps
+ * are estimated as value, next pointer and cached hash.
+ *
+ * @return MemoryFootprint
+ */
+MemoryFootprint CSVManager::memoryFootprint() const
+{
+    MemoryFootprint footprint;
+    footprint.studentBytes = sizeof(*this) - sizeof(table) + table.memoryFootprint();
+
+    const size_t nodeOverhead = sizeof(void *) + sizeof(size_t);
+    footprint.indexBytes = nameSlots.capacity() * sizeof(uint32_t);
+    footprint.indexBytes += groupIndex.bucket_count() * sizeof(void *);
+    for (auto const &group : groupIndex)
+        footprint.indexBytes += sizeof(group) + nodeOverhead + group.second.capacity() * sizeof(uint32_t);
+    for (auto const &yearMembers : yearIndex)
+        footprint.indexBytes += yearMembers.capacity() * sizeof(uint32_t);
+    if (std::shared_ptr<NameIndex const> index = std::atomic_load(&similarNames))
+        footprint.indexBytes += index->memoryFootprint();
+    return footprint;
+}
\ No newline at end of file
@@ -1,21 +1,118 @@
 #pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
-#include "Student.hpp"
+#include "CohortKey.hpp"
+#include "CompactRoster.hpp"
+#include "RosterIO.hpp"
+#include "NameIndex.hpp"
+
+#define NO_STUDENT UINT32_MAX
+
+/**
+ * @brief Rows of the roster changed by a reload
+ */
+struct RosterDiff
+{
+    size_t changed = 0; // rows with changed name, seminar group or points
+    size_t added = 0;
+    size_t removed = 0;
+    bool conflict = false; // not reloaded: the file changed while points in memory are unsaved
+};
+
+/**
+ * @brief Memory used by a roster in bytes: the object, its buffers and heap blocks as requested
+ * from the allocator (without the allocator's own overhead)
+ */
+struct MemoryFootprint
+{
+    size_t studentBytes = 0; // columns of the students with their names and seminar groups
+    size_t indexBytes = 0;   // indexes by name, seminar group, cohort year and trigram
+};
 
 class CSVManager
 {
 private:
     std::string filename;
-    std::vector<Student> students;
-    Student createStudentFromCSV(char *csvLine, size_t size);
-    std::string createCSVFromStudent(Student stud);
-    vector<Student> readCSV(string filename);
-    void writeCSV(string filename);
-    void changePoints(string name, bool incr);
+    CompactRoster table;                                             // students in columns
+    std::vector<uint32_t> nameSlots;                                 // open addressing: position of first student per name or NO_STUDENT
+    std::unordered_map<CohortKey, std::vector<uint32_t>> groupIndex; // positions of students per seminar group
+    std::array<std::vector<uint32_t>, 128> yearIndex;                // positions of students per cohort year
+    mutable std::shared_ptr<NameIndex const> similarNames;           // trigrams of names, built on first lookup of an unknown name
+    uint64_t version = 0; // hash of the roster content
+    uint64_t layoutHash = 0; // hash of names and seminar groups in roster order (points left out)
+    bool pointsChanged = false; // points differ from the content of the version
+    void appendStudentFromCSV(CompactRoster &students, char *csvLine, size_t size, std::pmr::memory_resource *lineArena);
+    std::string createCSVLine(uint32_t index, uint8_t points) const;
+    CompactRoster parseCSV(std::string &content);
+    bool writeCSV(std::string const &filename, uint8_t const *points, uint64_t &version) const;
+    bool writeCSV(std::string const &filename);
+    void changePoints(std::string const &name, bool incr);
+    void buildNameIndex();
+    void indexName(uint32_t index);
+    bool unindexName(uint32_t index);
+    void buildCohortIndex();
+    bool indexCohort(uint32_t index, CohortKey key);
+    void warnInvalidGroups(uint32_t count, uint32_t example) const;
+    void unindexCohort(uint32_t index, CohortKey key);
 
 public:
-    CSVManager(string filename);
-    Student *getStudent(string name);
-    void incrementPoints(string name);
-    void decrementPoints(string name);
-};
\ No newline at end of file
+    CSVManager(std::string const &filename);
+    CSVManager(std::string const &filename, FileContent file);
+    static std::vector<CSVManager> loadRosters(std::vector<std::string> const &filenames);
+    uint32_t getStudentIndex(std::string_view name) const;
+    std::vector<NameMatch> findSimilarNames(std::string const &name, size_t maxMatches) const;
+    /**
+     * @brief Returns number of students in the roster
+     */
+    size_t getStudentCount() const { return table.getStudentCount(); }
+    /**
+     * @brief Returns name of student at position <index> of the roster (valid until the roster changes)
+     */
+    std::string_view getName(uint32_t index) const { return table.getName(index); }
+    /**
+     * @brief Returns seminar group of student at position <index> of the roster
+     */
+    std::string const &getSemGroup(uint32_t index) const { return table.getSemGroup(index); }
+    /**
+     * @brief Returns points of student at position <index> of the roster
+     */
+    uint8_t getPoints(uint32_t index) const { return table.getPoints(index); }
+    /**
+     * @brief Returns parsed seminar group of student at position <index> of the roster
+     */
+    CohortKey getCohortKey(uint32_t index) const { return table.getCohortKey(index); }
+    std::vector<uint32_t> const &getGroupMembers(std::string const &group) const;
+    void incrementPoints(std::string const &name);
+    void decrementPoints(std::string const &name);
+    void adjustPoints(uint32_t index, bool doIncrement);
+    /**
+     * @brief Returns points of all students in roster order
+     */
+    std::vector<uint8_t> const &getPointsColumn() const { return table.getPointsColumn(); }
+    bool savePointsColumn(std::vector<uint8_t> const &points, uint64_t &version) const;
+    bool saveChanges();
+    RosterDiff reloadChanges();
+    /**
+     * @brief Returns name of the CSV-file of the roster
+     */
+    std::string const &getFilename() const { return filename; }
+    uint64_t getVersion() const;
+    /**
+     * @brief Returns hash of names and seminar groups in roster order. Unlike the version it does
+     * not change with points, so positions of students stay valid as long as it is equal.
+     */
+    uint64_t getLayoutHash() const { return layoutHash; }
+    /**
+     * @brief Returns true when points were changed in memory since the version was computed
+     */
+    bool hasUnsavedPoints() const { return pointsChanged; }
+    MemoryFootprint memoryFootprint() const;
+};
+
+size_t stringHeapBytes(std::string const &str);
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include "CohortKey.hpp"
+
+#define MAX_PROGRAM_LETTERS 3
+#define MAX_GROUP_DIGITS 3
+
+/**
+ * @brief Parses a seminar group in format XYINB-Z (2 digits year, 1 to 3 capital letters program,
+ * group number up to 255) into a packed key. Returns INVALID_COHORT when the format does not match.
+ *
+ * @param semGroup seminar group
+ * @return CohortKey
+ */
+CohortKey parseCohortKey(std::string const &semGroup)
+{
+    size_t pos = 0;
+    auto isDigit = [&semGroup](size_t i)
+    { return i < semGroup.size() && semGroup[i] >= '0' && semGroup[i] <= '9'; };
+    auto isLetter = [&semGroup](size_t i)
+    { return i < semGroup.size() && semGroup[i] >= 'A' && semGroup[i] <= 'Z'; };
+
+    // year
+    if (!isDigit(0) || !isDigit(1))
+        return INVALID_COHORT;
+    uint32_t year = (semGroup[0] - '0') * 10 + (semGroup[1] - '0');
+    pos = 2;
+
+    // program
+    uint32_t program = 0;
+    size_t letters = 0;
+    for (; isLetter(pos) && letters < MAX_PROGRAM_LETTERS; pos++, letters++)
+        program = (program << 5) | (semGroup[pos] - 'A' + 1);
+    if (letters == 0 || pos >= semGroup.size() || semGroup[pos] != '-')
+        return INVALID_COHORT;
+    pos++;
+
+    // group number
+    uint32_t group = 0;
+    size_t digits = 0;
+    for (; isDigit(pos) && digits < MAX_GROUP_DIGITS; pos++, digits++)
+        group = group * 10 + (semGroup[pos] - '0');
+    if (digits == 0 || pos != semGroup.size() || group > 0xff)
+        return INVALID_COHORT;
+
+    return (1u << 31) | (year << 24) | (program << 8) | group;
+}
+
+/**
+ * @brief Parses a cohort year in format XY (2 digits, e.g. 21 for all groups 21XXX-Z). Returns
+ * INVALID_YEAR when the format does not match.
+ *
+ * @param year cohort year
+ * @return int
+ */
+int parseCohortYear(std::string const &year)
+{
+    if (year.size() != 2 || year[0] < '0' || year[0] > '9' || year[1] < '0' || year[1] > '9')
+        return INVALID_YEAR;
+    return (year[0] - '0') * 10 + (year[1] - '0');
+}
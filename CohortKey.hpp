@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Seminar group (XYINB-Z) packed into an integer:
+ * bit 31 valid | bits 24-30 year (XY) | bits 8-23 program (INB, 5 bits per letter) | bits 0-7 group (Z)
+ */
+typedef uint32_t CohortKey;
+
+#define INVALID_COHORT 0
+#define INVALID_YEAR -1
+
+CohortKey parseCohortKey(std::string const &semGroup);
+int parseCohortYear(std::string const &year);
+
+/**
+ * @brief Returns year of the cohort (e.g. 21 for 21INB-1)
+ */
+inline uint8_t cohortYear(CohortKey key)
+{
+    return (key >> 24) & 0x7f;
+}
+
+/**
+ * @brief Returns packed program of the cohort (e.g. INB for 21INB-1)
+ */
+inline uint16_t cohortProgram(CohortKey key)
+{
+    return (key >> 8) & 0xffff;
+}
+
+/**
+ * @brief Returns group number of the cohort (e.g. 1 for 21INB-1)
+ */
+inline uint8_t cohortGroup(CohortKey key)
+{
+    return key & 0xff;
+}
+
+/**
+ * @brief Returns true when a student of cohort <studKey> is a repeater in cohort <currentKey>.
+ * Repeaters started in a different year. Students with invalid seminar group are no repeaters.
+ */
+inline bool isRepeater(CohortKey studKey, CohortKey currentKey)
+{
+    return studKey != INVALID_COHORT && cohortYear(studKey) != cohortYear(currentKey);
+}
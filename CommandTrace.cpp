@@ -0,0 +1,94 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "CommandTrace.hpp"
+
+#define TRACE_SEPARATOR '\t'
+
+/**
+ * @brief Appends the current program call to the trace file.
+ * Arguments for the trace file itself are left out, so replaying the trace does not record again.
+ *
+ * @param traceFile name of the trace file
+ * @param args arguments of the call (without program name) as given, before option processing
+ * @param rosterVersion version of the roster the call runs against
+ */
+void recordInvocation(std::string const &traceFile, std::vector<std::string> const &args, uint64_t rosterVersion)
+{
+    TraceEntry entry;
+    entry.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::system_clock::now().time_since_epoch())
+                          .count();
+    entry.rosterVersion = rosterVersion;
+    for (size_t i = 0; i < args.size(); i++)
+    {
+        if (args[i] == "--trace")
+            i++; // skip value as well
+        else if (args[i].rfind("--trace=", 0) != 0)
+            entry.args.push_back(args[i]);
+    }
+    appendTraceEntry(traceFile, entry);
+}
+
+/**
+ * @brief Appends one entry as a single tab-separated line to the trace file:
+ * <timestamp>\t<rosterVersion(hex)>\t<arg1>\t<arg2>...
+ *
+ * @param traceFile name of the trace file
+ * @param entry entry to append
+ */
+void appendTraceEntry(std::string const &traceFile, TraceEntry const &entry)
+{
+    std::ostringstream line;
+    line << entry.timestamp << TRACE_SEPARATOR << std::hex << entry.rosterVersion;
+    for (std::string const &arg : entry.args)
+        line << TRACE_SEPARATOR << arg;
+    line << '\n';
+
+    // single write, so concurrent calls do not interleave within a line
+    std::ofstream traceStream(traceFile, std::ios::app);
+    if (!traceStream)
+    {
+        std::cerr << "Error:\tCould not open trace file \"" << traceFile << "\"" << std::endl;
+        return;
+    }
+    traceStream << line.str();
+}
+
+/**
+ * @brief Reads all entries of the given trace file. Malformed lines are skipped with a warning.
+ *
+ * @param traceFile name of the trace file
+ * @return std::vector<TraceEntry>
+ */
+std::vector<TraceEntry> readTrace(std::string const &traceFile)
+{
+    std::vector<TraceEntry> entries;
+    std::ifstream traceStream(traceFile);
+    std::string line;
+    size_t lineNo = 0;
+    while (getline(traceStream, line))
+    {
+        lineNo++;
+        std::istringstream fields(line);
+        std::string field;
+        TraceEntry entry;
+        try
+        {
+            getline(fields, field, TRACE_SEPARATOR);
+            entry.timestamp = std::stoll(field);
+            getline(fields, field, TRACE_SEPARATOR);
+            entry.rosterVersion = std::stoull(field, nullptr, 16);
+        }
+        catch (std::logic_error &)
+        {
+            std::cerr << "Warning:\tSkipping malformed trace line " << lineNo << std::endl;
+            continue;
+        }
+        while (getline(fields, field, TRACE_SEPARATOR))
+            entry.args.push_back(field);
+        entries.push_back(entry);
+    }
+    return entries;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One recorded program call: when it happened, which roster version it ran against and the
+ * arguments it was called with (without program name).
+ */
+struct TraceEntry
+{
+    int64_t timestamp = 0; // nanoseconds since epoch
+    uint64_t rosterVersion = 0;
+    std::vector<std::string> args;
+};
+
+void recordInvocation(std::string const &traceFile, std::vector<std::string> const &args, uint64_t rosterVersion);
+void appendTraceEntry(std::string const &traceFile, TraceEntry const &entry);
+std::vector<TraceEntry> readTrace(std::string const &traceFile);
@@ -0,0 +1,141 @@
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include "CompactRoster.hpp"
+#include "CSVManager.hpp"
+
+/**
+ * @brief Reserves space for <count> students with names of <nameBytes> bytes in total
+ *
+ * @param count number of students
+ * @param nameBytes bytes of all names
+ */
+void CompactRoster::reserve(size_t count, size_t nameBytes)
+{
+    nameArena.reserve(nameBytes);
+    nameOffsets.reserve(count + 1);
+    groupCodes.reserve(count);
+    points.reserve(count);
+}
+
+/**
+ * @brief Appends a student. Throws std::length_error when the names exceed 4 GiB or there are more
+ * than 65536 distinct seminar groups.
+ *
+ * @param name name of student
+ * @param semGroup seminar group of student
+ * @param studPoints points of student
+ */
+void CompactRoster::append(std::string_view name, std::string_view semGroup, uint8_t studPoints)
+{
+    if (nameArena.size() + name.size() > UINT32_MAX)
+        throw std::length_error("names exceed 4 GiB (32-bit offsets)");
+    uint16_t code = groupCode(semGroup);
+    nameArena.append(name);
+    nameOffsets.push_back(nameArena.size());
+    groupCodes.push_back(code);
+    points.push_back(studPoints);
+}
+
+/**
+ * @brief Returns dictionary entry of seminar group <semGroup>, added when it is new. Throws
+ * std::length_error when there would be more than 65536 distinct seminar groups.
+ *
+ * @param semGroup seminar group
+ * @return uint16_t
+ */
+uint16_t CompactRoster::groupCode(std::string_view semGroup)
+{
+    auto group = groupLookup.find(std::string(semGroup));
+    if (group == groupLookup.end())
+    {
+        if (groups.size() > UINT16_MAX)
+            throw std::length_error("more than 65536 seminar groups (16-bit codes)");
+        group = groupLookup.emplace(semGroup, groups.size()).first;
+        groups.emplace_back(semGroup);
+        groupCohorts.push_back(parseCohortKey(groups.back()));
+    }
+    return group->second;
+}
+
+/**
+ * @brief Renames student at position <index>. The name is replaced in the arena and the offsets of
+ * the following students are shifted, so renaming costs a move of the names behind it. Throws
+ * std::length_error when the names would exceed 4 GiB.
+ *
+ * @param index position of student
+ * @param name new name
+ */
+void CompactRoster::setName(uint32_t index, std::string_view name)
+{
+    size_t oldLength = nameOffsets[index + 1] - nameOffsets[index];
+    if (nameArena.size() - oldLength + name.size() > UINT32_MAX)
+        throw std::length_error("names exceed 4 GiB (32-bit offsets)");
+    nameArena.replace(nameOffsets[index], oldLength, name);
+    for (size_t i = index + 1; i < nameOffsets.size(); i++)
+        nameOffsets[i] = nameOffsets[i] - oldLength + name.size();
+}
+
+/**
+ * @brief Changes seminar group of student at position <index>. Groups no longer used stay in the
+ * dictionary. Throws std::length_error when there would be more than 65536 distinct seminar groups.
+ *
+ * @param index position of student
+ * @param semGroup new seminar group
+ */
+void CompactRoster::setSemGroup(uint32_t index, std::string_view semGroup)
+{
+    groupCodes[index] = groupCode(semGroup);
+}
+
+/**
+ * @brief Removes all students from position <count> on
+ *
+ * @param count number of students to keep
+ */
+void CompactRoster::truncate(size_t count)
+{
+    if (count >= points.size())
+        return;
+    nameArena.resize(nameOffsets[count]);
+    nameOffsets.resize(count + 1);
+    groupCodes.resize(count);
+    points.resize(count);
+}
+
+/**
+ * @brief Returns bytes of the object and its buffers. Nodes of the group lookup are estimated as
+ * value, next pointer and cached hash.
+ *
+ * @return size_t
+ */
+size_t CompactRoster::memoryFootprint() const
+{
+    size_t bytes = sizeof(*this) + nameArena.capacity() + 1 + nameOffsets.capacity() * sizeof(uint32_t) +
+                   groups.capacity() * sizeof(std::string) + groupCohorts.capacity() * sizeof(CohortKey) +
+                   groupCodes.capacity() * sizeof(uint16_t) + points.capacity();
+    for (std::string const &group : groups)
+        bytes += 2 * stringHeapBytes(group); // dictionary and lookup
+    bytes += groupLookup.bucket_count() * sizeof(void *) +
+             groupLookup.size() * (sizeof(std::pair<const std::string, uint16_t>) + sizeof(void *) + sizeof(size_t));
+    return bytes;
+}
+
+/**
+ * @brief Prints memory used per student by the columns and the indexes of <roster>
+ *
+ * @param roster roster
+ * @param out stream to print to
+ */
+void printRosterFootprint(CSVManager const &roster, std::ostream &out)
+{
+    MemoryFootprint footprint = roster.memoryFootprint();
+    size_t count = roster.getStudentCount();
+    auto perStudent = [count](size_t bytes)
+    { return count ? (double)bytes / count : 0.0; };
+    out << "Memory of roster (" << count << " students):\n"
+        << std::fixed << std::setprecision(1)
+        << "  students\t" << footprint.studentBytes << " bytes\t" << perStudent(footprint.studentBytes) << " per student\n"
+        << "  indexes\t" << footprint.indexBytes << " bytes\t" << perStudent(footprint.indexBytes) << " per student\n"
+        << std::defaultfloat << std::flush;
+}
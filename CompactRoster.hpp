@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "CohortKey.hpp"
+
+/**
+ * @brief Students of a roster in columns: names back to back in one arena addressed by 32-bit
+ * offsets, seminar groups dictionary-encoded and points as a byte column. Costs a few bytes per
+ * student besides the names instead of an object with two std::string.
+ */
+class CompactRoster
+{
+private:
+    std::string nameArena;                                 // all names without separators
+    std::vector<uint32_t> nameOffsets = {0};               // name i is nameArena[nameOffsets[i]] to nameArena[nameOffsets[i + 1]]
+    std::vector<std::string> groups;                       // distinct seminar groups in order of first occurrence
+    std::vector<CohortKey> groupCohorts;                   // parsed seminar group per dictionary entry
+    std::unordered_map<std::string, uint16_t> groupLookup; // dictionary entry per seminar group
+    std::vector<uint16_t> groupCodes;                      // dictionary entry per student
+    std::vector<uint8_t> points;                           // points per student
+
+    uint16_t groupCode(std::string_view semGroup);
+
+public:
+    void reserve(size_t count, size_t nameBytes);
+    void append(std::string_view name, std::string_view semGroup, uint8_t studPoints);
+    void setName(uint32_t index, std::string_view name);
+    void setSemGroup(uint32_t index, std::string_view semGroup);
+    void truncate(size_t count);
+    /**
+     * @brief Returns number of students in the roster
+     */
+    size_t getStudentCount() const { return points.size(); }
+    /**
+     * @brief Returns name of student at position <index>
+     */
+    std::string_view getName(uint32_t index) const
+    {
+        return std::string_view(nameArena).substr(nameOffsets[index], nameOffsets[index + 1] - nameOffsets[index]);
+    }
+    /**
+     * @brief Returns seminar group of student at position <index>
+     */
+    std::string const &getSemGroup(uint32_t index) const { return groups[groupCodes[index]]; }
+    /**
+     * @brief Returns parsed seminar group of student at position <index>
+     */
+    CohortKey getCohortKey(uint32_t index) const { return groupCohorts[groupCodes[index]]; }
+    /**
+     * @brief Returns points of student at position <index>
+     */
+    uint8_t getPoints(uint32_t index) const { return points[index]; }
+    /**
+     * @brief Sets points of student at position <index>
+     */
+    void setPoints(uint32_t index, uint8_t value) { points[index] = value; }
+    /**
+     * @brief Returns points of all students in roster order
+     */
+    std::vector<uint8_t> const &getPointsColumn() const { return points; }
+    /**
+     * @brief Returns number of distinct seminar groups
+     */
+    size_t getGroupCount() const { return groups.size(); }
+    size_t memoryFootprint() const;
+};
+
+class CSVManager;
+void printRosterFootprint(CSVManager const &roster, std::ostream &out);
@@ -0,0 +1,74 @@
+#include "DecisionCache.hpp"
+
+/**
+ * @brief Returns the cache shared by all pipelines of the process
+ *
+ * @return DecisionCache&
+ */
+DecisionCache &DecisionCache::shared()
+{
+    static DecisionCache cache;
+    return cache;
+}
+
+/**
+ * @brief Returns cached decision of <request>, nullptr when there is none or the entry with its key
+ * belongs to another request (hash collision)
+ *
+ * @param request roster version and request
+ * @return std::shared_ptr<const CachedDecision>
+ */
+std::shared_ptr<const CachedDecision> DecisionCache::find(DecisionRequest const &request)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(request.hash());
+    if (it == entries.end() || !(it->second->request == request))
+    {
+        misses++;
+        return nullptr;
+    }
+    hits++;
+    return it->second;
+}
+
+/**
+ * @brief Caches <decision> under the key of its request
+ *
+ * @param decision request and remaining candidates before the random pick
+ */
+void DecisionCache::insert(std::shared_ptr<const CachedDecision> decision)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (entries.size() >= DECISION_CACHE_CAPACITY)
+        entries.clear();
+    uint64_t key = decision->request.hash();
+    entries[key] = std::move(decision);
+}
+
+/**
+ * @brief Removes all cached decisions
+ *
+ */
+void DecisionCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+}
+
+/**
+ * @brief Returns number of lookups that found a decision
+ */
+uint64_t DecisionCache::getHits()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+}
+
+/**
+ * @brief Returns number of lookups that found no decision
+ */
+uint64_t DecisionCache::getMisses()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+}
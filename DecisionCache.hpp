@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "CohortKey.hpp"
+#include "DescisionPipeline.hpp"
+
+#define DECISION_CACHE_CAPACITY 1024 // entries; the cache is emptied when full
+
+/**
+ * @brief Continues hash <seed> with <value>
+ */
+inline uint64_t hashCombine(uint64_t seed, uint64_t value)
+{
+    value += 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+    value ^= value >> 31;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    return seed ^ (value ^ (value >> 29));
+}
+
+/**
+ * @brief Everything the deterministic part of a decision depends on
+ */
+struct DecisionRequest
+{
+    uint64_t rosterVersion = 0;
+    uint64_t selectionHash = 0;       // selected students with their seating rows
+    CohortKey semCohort = INVALID_COHORT;
+    uint8_t preferredPoints = 0;
+    uint8_t priorityCorrectSemGroup = 0;
+    uint8_t priorityRepeater = 0;
+    bool allowRepeater = false;
+    uint8_t variant = 0;              // specialization of decide(): repeater mode and rows
+
+    bool operator==(DecisionRequest const &other) const
+    {
+        return rosterVersion == other.rosterVersion && selectionHash == other.selectionHash &&
+               semCohort == other.semCohort && preferredPoints == other.preferredPoints &&
+               priorityCorrectSemGroup == other.priorityCorrectSemGroup && priorityRepeater == other.priorityRepeater &&
+               allowRepeater == other.allowRepeater && variant == other.variant;
+    }
+
+    /**
+     * @brief Returns key of the request in the decision cache
+     */
+    uint64_t hash() const
+    {
+        uint64_t key = hashCombine(rosterVersion, selectionHash);
+        key = hashCombine(key, semCohort);
+        key = hashCombine(key, preferredPoints);
+        key = hashCombine(key, priorityCorrectSemGroup);
+        key = hashCombine(key, priorityRepeater);
+        key = hashCombine(key, allowRepeater);
+        return hashCombine(key, variant);
+    }
+};
+
+/**
+ * @brief Remaining candidates of a decision before the random pick
+ */
+struct CachedDecision
+{
+    DecisionRequest request;
+    std::vector<Candidate> finalists;
+};
+
+/**
+ * @brief Process-wide cache of the deterministic part of decisions, keyed by the hash of the request.
+ * Entries of a roster are never stale: the version is the hash of the roster content, so any change
+ * of points leads to other requests. Safe for concurrent pipelines.
+ *
+ * Only long-lived hosts gain from it (library callers of decision_api, simulations): a call of
+ * Descision-Helper decides once per process and always starts with an empty cache.
+ */
+class DecisionCache
+{
+private:
+    std::mutex mutex;
+    std::unordered_map<uint64_t, std::shared_ptr<const CachedDecision>> entries;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+public:
+    static DecisionCache &shared();
+    std::shared_ptr<const CachedDecision> find(DecisionRequest const &request);
+    void insert(std::shared_ptr<const CachedDecision> decision);
+    void clear();
+    uint64_t getHits();
+    uint64_t getMisses();
+};
@@ -1,199 +1,420 @@
 #include <iostream>
-#include <set>
 #include <limits>
+#include <optional>
 #include <algorithm>
 #include <iterator>
 #include <random>
-#include <time.h>
+#include <set>
+#include <thread>
 #include "DescisionPipeline.hpp"
+#include "Metrics.hpp"
+#include "DecisionCache.hpp"
+#include "WorkerPool.hpp"
 
 #define PADDING 15
 
 /**
- * @brief Returns set of student-names from given map with closest amount of points <= <leqPoints>
+ * @brief Relative cost per candidate of the filter rules
+ */
+static const double filterCosts[FILTER_RULE_COUNT] = {
+    1, // ruleUnavailable: test of one bit
+    2  // ruleRepeaters: load of seminar group and comparison
+};
+
+/**
+ * @brief Rule counted for selectivity of every rule stage (RULE_COUNT: stage removes no candidates)
+ */
+static const DecisionRule stageRules[STAGE_COUNT] = {
+    RULE_COUNT,      // stageFilters (counted per filter)
+    rulePoints,      // stagePreferredPoints
+    RULE_COUNT,      // stagePriorize
+    ruleMaxPriority, // stageRemoveLeastPriorized
+    ruleFrontRow     // stageFurthestInFront
+};
+
+/**
+ * @brief Names of the rules in the selectivity report
+ */
+static const char *const ruleNames[RULE_COUNT] = {"unavailable", "repeaters", "preferred_points", "max_priority", "front_row"};
+
+/**
+ * @brief Warning of decisions that keep repeaters, because the seminar group was not specified
+ */
+static const char *const repeaterWarning = "WARNING - Could not sort out repeaters, because the seminar group was not specified.";
+
+/**
+ * @brief Measured phase of every rule stage
+ */
+static const MetricPhase stagePhases[STAGE_COUNT] = {
+    phaseFirstSortingOut,  // stageFilters
+    phaseFirstSortingOut,  // stagePreferredPoints
+    phasePrioritization,   // stagePriorize
+    phaseSecondSortingOut, // stageRemoveLeastPriorized
+    phaseSecondSortingOut  // stageFurthestInFront
+};
+#define SCRATCH_ALIGNMENT_SLACK 64
+// layout of rank scores (lower score ranks higher):
+// bits 48-63 points distance | bits 40-47 inverted priority | bits 16-39 row | bits 0-15 random
+#define RANK_POINTS_SHIFT 48
+#define RANK_PRIORITY_SHIFT 40
+#define RANK_ROW_SHIFT 16
+#define RANK_ROW_MAX 0xffffff
+#define RANK_RANDOM_MASK 0xffff
+#define SUGGESTED_NAMES 3
+// a similar name replaces an unknown name when it is that similar and clearly ahead of the next one
+#define AUTO_RESOLVE_SIMILARITY 0.45
+#define AUTO_RESOLVE_MARGIN 0.1
+
+/**
+ * @brief Removes all candidates for which <discard> returns true. The order of the remaining
+ * candidates is kept. Every removed student is recorded with event <eventType>.
  *
- * @param leqPoints point border to search for downwards
- * @param studs map for search
- * @return std::set<std::string>
+ * @param discard predicate for candidates to remove
+ * @param eventType event to record for removed students
  */
-std::set<std::string> DescisionPipeline::closestLEQPointsStudents(uint8_t leqPoints, std::map<std::string, uint8_t> studs)
+template <bool Log, typename Predicate>
+void DescisionPipeline::discardCandidatesIf(Predicate discard, DecisionEventType eventType)
 {
-    if (input->verbose)
-        std::cout << "Searching for students with " << to_string(leqPoints) << " points";
-    // Find students with points equal leqPoints
-    std::set<std::string> closestStuds;
-    for (auto it = studs.begin(); it != studs.end(); ++it)
+    size_t remaining = 0;
+    for (size_t i = 0; i < candidates.size(); i++)
     {
-        if (this->csvMan.getStudent(it->first)->getPoints() == leqPoints)
-            closestStuds.insert(it->first);
-    }
-    // return when Students found, otherwise recur method with leqPoints -1 if possible
-    if (closestStuds.empty() && leqPoints > 0)
-    {
-        if (input->verbose)
-            std::cout << "\t- no student found\n";
-        return closestLEQPointsStudents(--leqPoints, studs);
-    }
-    else
-    {
-        if (input->verbose && !closestStuds.empty())
+        if (discard(candidates[i]))
         {
-            std::cout << "\t- found:\n";
-            listStrings(closestStuds);
+            if constexpr (Log)
+                events.record({eventType, 0, 0, csvMan.getName(candidates[i].stud)});
         }
+        else
+            candidates[remaining++] = candidates[i];
+    }
+    candidates.resize(remaining);
+}
+
+/**
+ * @brief Returns number of seating rows of the selection of <input>
+ *
+ * @param input InputStruct holding the selection
+ * @return size_t
+ */
+static size_t selectionRowCount(InputStruct const *input)
+{
+    std::set<int> rows;
+    for (auto const &studRow : input->studSelection)
+        rows.insert(studRow.first);
+    for (auto const &groupRow : input->groupSelection)
+        rows.insert(groupRow.first);
+    return rows.size();
+}
 
-        return closestStuds;
+/**
+ * @brief Returns file of the seating plan to decide on, empty when <input> has no plan to load
+ *
+ * @param input InputStruct holding the request
+ * @return std::string
+ */
+static std::string planToLoad(InputStruct const *input)
+{
+    if (input->planName == "" || input->state == planSaving)
+        return "";
+    return planFilename(input->csvFile, input->planName);
+}
+
+/**
+ * @brief Returns size of the scratch arena for decisions on the selection of <input>. Requires
+ * loaded roster and plan.
+ *
+ * @param input InputStruct holding the selection
+ * @return size_t
+ */
+size_t DescisionPipeline::scratchSizeFor(InputStruct const *input) const
+{
+    size_t selectionSize = plan.size();
+    for (auto const &studRow : input->studSelection)
+        selectionSize += studRow.second.size();
+    for (auto const &groupRow : input->groupSelection)
+    {
+        for (std::string const &group : groupRow.second)
+            selectionSize += csvMan.getGroupMembers(group).size();
     }
+    return selectionSize * sizeof(Candidate) + SCRATCH_ALIGNMENT_SLACK;
 }
+
 /**
- * @brief Returns set of student-names from given map with closest amount of points >= <geqPoints>
+ * @brief Returns position of student <studName> in the roster. Unknown names are reported with the
+ * most similar names of the roster; with auto-resolve an unambiguous similar name is used instead.
+ * Returns NO_STUDENT when the name is not resolved.
  *
- * @param geqPoints point border to search for upwards
- * @param studs map for search
- * @return std::set<std::string>
+ * @param studName name of student
+ * @return uint32_t
  */
-std::set<std::string> DescisionPipeline::closestGEQPointsStudents(uint8_t geqPoints, std::map<std::string, uint8_t> studs)
+uint32_t DescisionPipeline::resolveStudent(std::string const &studName)
 {
-    if (input->verbose)
-        std::cout << "Searching for students with " << to_string(geqPoints) << " points";
-    // Find students with points equal geqPoints
-    std::set<std::string> closestStuds;
-    for (auto it = studs.begin(); it != studs.end(); ++it)
+    uint32_t stud = csvMan.getStudentIndex(studName);
+    if (stud != NO_STUDENT)
+        return stud;
+    std::vector<NameMatch> matches = csvMan.findSimilarNames(studName, SUGGESTED_NAMES);
+    if (input->autoResolve && !matches.empty() && matches.front().similarity >= AUTO_RESOLVE_SIMILARITY &&
+        (matches.size() == 1 || matches[1].similarity < matches.front().similarity - AUTO_RESOLVE_MARGIN))
     {
-        if (this->csvMan.getStudent(it->first)->getPoints() == geqPoints)
-            closestStuds.insert(it->first);
+        std::cout << "Student \"" << studName << "\" does not exist, using \""
+                  << csvMan.getName(matches.front().stud) << "\".\n";
+        return matches.front().stud;
     }
-    // return when Students found, otherwise recur method with greaterPoints + 1 (and geqPoints no overflow to terminate)
-    if (closestStuds.empty() && (uint8_t)(geqPoints + 1) >= geqPoints)
+    std::cout << "Student \"" << studName << "\" does not exist.";
+    for (size_t i = 0; i < matches.size(); i++)
+        std::cout << (i == 0 ? " Did you mean \"" : ", \"") << csvMan.getName(matches[i].stud) << "\"";
+    std::cout << (matches.empty() ? "\n" : "?\n");
+    return NO_STUDENT;
+}
+
+/**
+ * @brief Releases the scratch memory of the previous decision and restores the candidates to the
+ * whole selection
+ *
+ */
+void DescisionPipeline::resetCandidates()
+{
+    candidates = std::pmr::vector<Candidate>(&scratchArena); // give memory back before release
+    scratchArena.release();
+    candidates.reserve(selection.size());
+    candidates.assign(selection.begin(), selection.end());
+}
+
+/**
+ * @brief Returns number of parts the candidates are split into for a rule pass: 1 below the
+ * parallel threshold, otherwise one part per thread
+ *
+ * @return unsigned
+ */
+unsigned DescisionPipeline::candidateParts() const
+{
+    if (candidates.size() < parallelThreshold || candidates.size() < 2)
+        return 1;
+    return std::min<size_t>({parallelThreads, candidates.size(), PARALLEL_MAX_PARTS});
+}
+
+/**
+ * @brief Splits the candidates into <parts> contiguous parts and calls <pass>(begin, end, part) for
+ * every part. Parts run on the threads of the shared worker pool, the first one on the calling
+ * thread. Passes must only write to their own candidates or to per-part results, which the caller
+ * reduces in part order.
+ *
+ * @param parts number of parts (1 = sequential)
+ * @param pass function called per part with its range of candidate indexes
+ */
+template <typename Pass>
+void DescisionPipeline::forEachCandidatePart(unsigned parts, Pass pass)
+{
+    if (parts <= 1)
     {
-        if (input->verbose)
-            std::cout << "\t- no student found\n";
-        return closestGEQPointsStudents(++geqPoints, studs);
+        pass(0, candidates.size(), 0);
+        return;
     }
-    else
+    size_t partSize = (candidates.size() + parts - 1) / parts;
+    auto runPart = [this, &pass, partSize](unsigned part)
     {
-        if (input->verbose && !closestStuds.empty())
-        {
-            std::cout << "\t- found:\n";
-            listStrings(closestStuds);
-        }
+        size_t begin = std::min(part * partSize, candidates.size());
+        pass(begin, std::min(begin + partSize, candidates.size()), part);
+    };
+    WorkerPool::shared().run(parts, runPart);
+}
 
-        return closestStuds;
-    }
+/**
+ * @brief Restores the candidates a previous decision on the same request ended with
+ *
+ * @param cached remaining candidates before the random pick
+ */
+void DescisionPipeline::restoreCandidates(std::vector<Candidate> const &cached)
+{
+    candidates = std::pmr::vector<Candidate>(&scratchArena);
+    scratchArena.release();
+    candidates.assign(cached.begin(), cached.end());
 }
+
 /**
- * @brief Returns maximal priorize value in map for student priorizing.
+ * @brief Returns the current decision as request of the decision cache: roster version, selection
+ * and everything the rules depend on
  *
- * @return uint8_t
+ * @return DecisionRequest
  */
-uint8_t DescisionPipeline::getMaxPriorizing()
+DecisionRequest DescisionPipeline::decisionRequest() const
+{
+    DecisionRequest request;
+    request.rosterVersion = csvMan.getVersion();
+    request.selectionHash = selectionHash;
+    request.semCohort = semCohort;
+    request.preferredPoints = input->preferredPoints;
+    request.priorityCorrectSemGroup = input->priorityCorrectSemGroup;
+    request.priorityRepeater = input->priorityRepeater;
+    request.allowRepeater = input->allowRepeater;
+    request.variant = repeaterMode() * 2 + (rowCount > 1);
+    return request;
+}
+
+/**
+ * @brief Counts candidates per amount of points
+ *
+ */
+void DescisionPipeline::fillPointsHistogram()
 {
-    uint8_t max = 0;
-    for (auto stud : studPriorizing)
+    pointsHistogram.fill(0);
+    unsigned parts = candidateParts();
+    if (parts == 1)
     {
-        if (stud.second > max)
-            max = stud.second;
+        for (Candidate const &cand : candidates)
+            pointsHistogram[points[cand.stud]]++;
+        return;
+    }
+    // histogram per part, summed afterwards
+    std::vector<std::array<uint32_t, 256>> partHistograms(parts);
+    forEachCandidatePart(parts, [this, &partHistograms](size_t begin, size_t end, unsigned part)
+                         {
+        std::array<uint32_t, 256> &histogram = partHistograms[part];
+        histogram.fill(0);
+        for (size_t i = begin; i < end; i++)
+            histogram[points[candidates[i].stud]]++; });
+    for (std::array<uint32_t, 256> const &histogram : partHistograms)
+    {
+        for (size_t points = 0; points < histogram.size(); points++)
+            pointsHistogram[points] += histogram[points];
     }
-    return max;
 }
+
 /**
- * @brief Removes all students from map for student priorizing, whose priorize value is less than
- * <priorizeValue>.
+ * @brief Searches the closest amount of points <= <leqPoints> any candidate has. Returns number of
+ * candidates with that amount and sets <leqPoints> to it. Returns 0 when there is no such candidate.
+ * Requires filled points histogram.
  *
- * @param priorizeValue Threshold value
+ * @param leqPoints point border to search for downwards; set to found amount of points
+ * @return size_t
  */
-void DescisionPipeline::removeLessPriorizedThen(uint8_t priorizeValue)
+template <bool Log>
+size_t DescisionPipeline::closestLEQPoints(uint8_t &leqPoints)
 {
-    std::string discardStudents;
-    for (auto stud : studPriorizing)
+    while (true)
     {
-        if (stud.second < priorizeValue)
+        size_t found = pointsHistogram[leqPoints];
+        if constexpr (Log)
         {
-            if (input->verbose)
-                discardStudents.append(stud.first + ", ");
-            studPriorizing.erase(stud.first);
+            events.record({evPointsSearch, leqPoints, (int)found});
+            logListedWithPoints(leqPoints);
         }
+        // return when Students found, otherwise continue with leqPoints -1 if possible
+        if (found > 0 || leqPoints == 0)
+            return found;
+        leqPoints--;
     }
-    if (input->verbose)
+}
+/**
+ * @brief Searches the closest amount of points >= <geqPoints> any candidate has. Returns number of
+ * candidates with that amount and sets <geqPoints> to it. Returns 0 when there is no such candidate.
+ * Requires filled points histogram.
+ *
+ * @param geqPoints point border to search for upwards; set to found amount of points
+ * @return size_t
+ */
+template <bool Log>
+size_t DescisionPipeline::closestGEQPoints(uint8_t &geqPoints)
+{
+    while (true)
     {
-        if (!discardStudents.empty())
+        size_t found = pointsHistogram[geqPoints];
+        if constexpr (Log)
         {
-            discardStudents.pop_back(); // remove ' '
-            discardStudents.pop_back(); // remove ','
+            events.record({evPointsSearch, geqPoints, (int)found});
+            logListedWithPoints(geqPoints);
         }
-        std::cout << "Discarding students with less than " << to_string(priorizeValue) << " priority\n\t" << discardStudents << "\n";
+        // return when Students found, otherwise continue with geqPoints + 1 (no overflow to terminate)
+        if (found > 0 || geqPoints == std::numeric_limits<uint8_t>::max())
+            return found;
+        geqPoints++;
     }
 }
 /**
- * @brief Reduces map for student priorizing to students with highest priorize value
+ * @brief Returns maximal priorize value of the candidates.
  *
+ * @return uint8_t
  */
+uint8_t DescisionPipeline::getMaxPriorizing()
+{
+    unsigned parts = candidateParts();
+    std::array<uint8_t, PARALLEL_MAX_PARTS> partMax{}; // no allocation for sequential passes
+    forEachCandidatePart(parts, [this, &partMax](size_t begin, size_t end, unsigned part)
+                         {
+        for (size_t i = begin; i < end; i++)
+            partMax[part] = std::max(partMax[part], candidates[i].priority); });
+    return *std::max_element(partMax.begin(), partMax.begin() + parts);
+}
+/**
+ * @brief Removes all candidates whose priorize value is less than <priorizeValue>.
+ *
+ * @param priorizeValue Threshold value
+ */
+template <bool Log>
+void DescisionPipeline::removeLessPriorizedThen(uint8_t priorizeValue)
+{
+    if constexpr (Log)
+        events.record({evDiscardLessPriority, priorizeValue});
+    discardCandidatesIf<Log>([priorizeValue](Candidate const &cand)
+                             { return cand.priority < priorizeValue; },
+                             evDiscarded);
+    if constexpr (Log)
+        events.record({evListEnd});
+}
+/**
+ * @brief Reduces candidates to students with highest priorize value
+ *
+ */
+template <bool Log>
 void DescisionPipeline::removeLeastPriorized()
 {
     uint8_t maxPriorize = getMaxPriorizing();
-    if (input->verbose)
-        std::cout << "Max priorize-value: " << to_string(maxPriorize) << std::endl;
-    removeLessPriorizedThen(maxPriorize);
+    if constexpr (Log)
+        events.record({evMaxPriority, maxPriorize});
+    removeLessPriorizedThen<Log>(maxPriorize);
 }
 /**
- * @brief Removes repeaters (recognized by differing from semGroup)
+ * @brief Removes repeaters (recognized by differing year of seminar group)
  *
- * @param semGroup current seminar group
+ * @param semCohort current seminar group (valid)
  */
-void DescisionPipeline::removeRepeaters(std::string semGroup)
+template <bool Log>
+void DescisionPipeline::removeRepeaters(CohortKey semCohort)
 {
-    for (auto it = this->studPriorizing.begin(); it != this->studPriorizing.end();)
-    {
-        std::string studName = it->first;
-        std::string studSemGroup = this->csvMan.getStudent(studName)->getSemGroup();
-        // Repeaters seminar group differ guaranteed in second digit of the year (XYINB-Z)
-        if (studSemGroup.at(1) != semGroup.at(1))
-        {
-            it = studPriorizing.erase(it);
-            if (input->verbose)
-                std::cout << "Removing repeater \t" << studName << std::endl;
-        }
-        else
-        {
-            ++it;
-        }
-    }
+    discardCandidatesIf<Log>([this, semCohort](Candidate const &cand)
+                             { return isRepeater(csvMan.getCohortKey(cand.stud), semCohort); },
+                             evRepeaterRemoved);
 }
 /**
- * @brief Returns the name of a random student in the priorizing collection
+ * @brief Returns the roster position of a random candidate
  *
- * @return std::string
+ * @return uint32_t
  */
-std::string DescisionPipeline::getRandomStudent()
+uint32_t DescisionPipeline::getRandomStudent()
 {
-    srand(time(NULL));
-    int randInt = rand() % studPriorizing.size();
-    std::map<std::string, uint8_t>::iterator it = studPriorizing.begin();
-    for (int i = 0; i < randInt; i++)
-    {
-        it++;
-    }
-    return it->first;
+    std::uniform_int_distribution<size_t> pick(0, candidates.size() - 1);
+    return candidates[pick(rng)].stud;
 }
 /**
- * @brief Prints all strings from set to terminal.
+ * @brief Records all candidates as listed.
  *
- * @param listingSet
  */
-void DescisionPipeline::listStrings(std::set<std::string> const &listingSet)
+void DescisionPipeline::logListed()
 {
-    for (auto str : listingSet)
-        std::cout << "\t" << str << std::endl;
+    for (Candidate const &cand : candidates)
+        events.record({evListed, 0, 0, csvMan.getName(cand.stud)});
 }
 /**
- * @brief Prints all strings of given map to terminal
+ * @brief Records all candidates with <points> points as listed.
  *
- * @param listingMap std::map to be printed
+ * @param points amount of points
  */
-void DescisionPipeline::listStrings(std::map<std::string, uint8_t> const &listingMap)
+void DescisionPipeline::logListedWithPoints(uint8_t points)
 {
-    for (auto pair : listingMap)
-        std::cout << "\t" << pair.first << std::endl;
+    for (Candidate const &cand : candidates)
+    {
+        if (this->points[cand.stud] == points)
+            events.record({evListed, 0, 0, csvMan.getName(cand.stud)});
+    }
 }
 
 /**
@@ -206,86 +427,89 @@ void DescisionPipeline::listStrings(std::map<std::string, uint8_t> const &listin
  *
  * @param preferredPoints preferred number of points
  */
+template <bool Log>
 void DescisionPipeline::rulePreferredPoints(uint8_t preferredPoints)
 {
-    if (input->verbose) // verbose output
-        std::cout << "preferred points: " << to_string(preferredPoints) << std::endl;
-    // Find students to remain
-    std::set<std::string> remainingStuds = closestLEQPointsStudents(preferredPoints, this->studPriorizing);
+    if constexpr (Log)
+        events.record({evPreferredPoints, preferredPoints});
+    // Find points of students to remain
+    fillPointsHistogram();
+    uint8_t remainingPoints = preferredPoints;
     // Check if students were found that have preferred points
-    if (remainingStuds.empty())
-    {
-        if (input->verbose) // verbose output
-        {
-            std::cout << "\nNo student with <= " << to_string(preferredPoints) << " points found.\n"
-                      << "Searching for students with > " << to_string(preferredPoints) << " points\n";
-        }
-        remainingStuds = closestGEQPointsStudents(preferredPoints + 1, this->studPriorizing);
-    }
-    // Discard students from map that are not remaining students
-    std::string discardedStuds;
-    for (auto it = this->studPriorizing.begin(); it != this->studPriorizing.end();)
-    {
-        std::string studName = it->first;
-        if (remainingStuds.find(studName) == remainingStuds.end()) // if studName not exists in remainStuds
-        {
-            if (input->verbose)
-                discardedStuds.append(it->first + ", ");
-            it = this->studPriorizing.erase(it); // iterator points to position after erased element
-        }
-        else
-            it++;
-    }
-    if (input->verbose)
+    if (closestLEQPoints<Log>(remainingPoints) == 0)
     {
-        if (!discardedStuds.empty())
-        {
-            discardedStuds.pop_back(); // remove ' '
-            discardedStuds.pop_back(); // remove ','
-        }
-        std::cout << "Discarding all other students of selection\n\t" << discardedStuds << "\n";
+        if constexpr (Log)
+            events.record({evNoLEQFound, preferredPoints});
+        remainingPoints = preferredPoints + 1;
+        closestGEQPoints<Log>(remainingPoints);
     }
+    // Discard students that do not have the points of remaining students
+    if constexpr (Log)
+        events.record({evDiscardOthers});
+    discardCandidatesIf<Log>([this, remainingPoints](Candidate const &cand)
+                             { return points[cand.stud] != remainingPoints; },
+                             evDiscarded);
+    if constexpr (Log)
+        events.record({evListEnd});
 }
 /**
  * @brief Adds <priorityValue> to priority count of each student belonging in the seminar.
  *
- * @param semGroup current seminar group
+ * @param semCohort current seminar group (valid)
  * @param priorityValue value added to priority count
  */
-void DescisionPipeline::rulePriorizeCorrectSemGroup(std::string semGroup, uint8_t priorityValue)
+template <bool Log>
+void DescisionPipeline::rulePriorizeCorrectSemGroup(CohortKey semCohort, uint8_t priorityValue)
 {
-    for (auto it = this->studPriorizing.begin(); it != this->studPriorizing.end(); ++it)
+    if constexpr (!Log)
+    {
+        // candidates are independent, so parts are scored without synchronization
+        forEachCandidatePart(candidateParts(), [this, semCohort, priorityValue](size_t begin, size_t end, unsigned)
+                             {
+            for (size_t i = begin; i < end; i++)
+            {
+                if (csvMan.getCohortKey(candidates[i].stud) == semCohort)
+                    candidates[i].priority += priorityValue;
+            } });
+        return;
+    }
+    for (Candidate &cand : candidates)
     {
-        std::string studName = it->first;
         // students semGroup equals current semGroup?
-        if (this->csvMan.getStudent(studName)->getSemGroup() == semGroup)
+        if (csvMan.getCohortKey(cand.stud) == semCohort)
         {
-            this->studPriorizing.at(studName) += priorityValue; // increase priority
-            if (input->verbose)                                 // verbose output
-                std::cout << padTo(studName, PADDING) << "\tis in correct seminar\t- priorize by " << to_string(priorityValue) << std::endl;
+            cand.priority += priorityValue; // increase priority
+            events.record({evCorrectSemGroup, priorityValue, 0, csvMan.getName(cand.stud)});
         }
     }
 }
 /**
  * @brief Adds <priorityValue> to priority count of repeaters. Repeaters will be recognized by the
- * 2nd digit of their seminar group (2nd digit of the year), since it has to differ for being
- * repeater.
+ * year of their seminar group, since it has to differ for being repeater.
  *
- * @param semGroup current seminar group
+ * @param semCohort current seminar group (valid)
  * @param priorityValue value added to priority count
  */
-void DescisionPipeline::rulePriorizeRepeaters(std::string semGroup, uint8_t priorityValue)
+template <bool Log>
+void DescisionPipeline::rulePriorizeRepeaters(CohortKey semCohort, uint8_t priorityValue)
 {
-    for (auto it = this->studPriorizing.begin(); it != this->studPriorizing.end(); ++it)
+    if constexpr (!Log)
+    {
+        forEachCandidatePart(candidateParts(), [this, semCohort, priorityValue](size_t begin, size_t end, unsigned)
+                             {
+            for (size_t i = begin; i < end; i++)
+            {
+                if (isRepeater(csvMan.getCohortKey(candidates[i].stud), semCohort))
+                    candidates[i].priority += priorityValue;
+            } });
+        return;
+    }
+    for (Candidate &cand : candidates)
     {
-        std::string studName = it->first;
-        std::string studSemGroup = this->csvMan.getStudent(studName)->getSemGroup();
-        // Repeaters seminar group differ guaranteed in second digit of the year (XYINB-Z)
-        if (studSemGroup.at(1) != semGroup.at(1))
+        if (isRepeater(csvMan.getCohortKey(cand.stud), semCohort))
         {
-            this->studPriorizing.at(studName) += priorityValue; // increase priority
-            if (input->verbose)                                 // verbose output
-                std::cout << padTo(studName, PADDING) << "\tseems to be repeater\t- priorize by " << to_string(priorityValue) << std::endl;
+            cand.priority += priorityValue; // increase priority
+            events.record({evRepeaterPriorized, priorityValue, 0, csvMan.getName(cand.stud)});
         }
     }
 }
@@ -293,201 +517,827 @@ void DescisionPipeline::rulePriorizeRepeaters(std::string semGroup, uint8_t prio
  * @brief Removes all students except those sitting furthest in front.
  *
  */
+template <bool Log>
 void DescisionPipeline::ruleFurthestInFront()
 {
-    // collect current selection of students as set
-    std::set<std::string> studSelection;
-    for (auto stud : studPriorizing)
+    // determine smallest row of the candidates
+    unsigned parts = candidateParts();
+    std::array<int, PARALLEL_MAX_PARTS> partFrontRows;
+    partFrontRows.fill(std::numeric_limits<int>::max());
+    forEachCandidatePart(parts, [this, &partFrontRows](size_t begin, size_t end, unsigned part)
+                         {
+        for (size_t i = begin; i < end; i++)
+            partFrontRows[part] = std::min(partFrontRows[part], candidates[i].row); });
+    int frontRow = *std::min_element(partFrontRows.begin(), partFrontRows.begin() + parts);
+
+    if constexpr (Log)
     {
-        studSelection.insert(stud.first);
+        events.record({evFurthestInFront});
+        for (Candidate const &cand : candidates)
+        {
+            if (cand.row == frontRow)
+                events.record({evListed, 0, 0, csvMan.getName(cand.stud)});
+        }
+        events.record({evDiscardOthers});
     }
 
-    // determine which students in row(ASC) are contained in selection
-    std::set<std::string> studsInRow;
-    std::set<std::string> priorizedStudsInRow;
-    for (int i = 0; priorizedStudsInRow.empty(); i++)
+    // discard all students not sitting in front row
+    discardCandidatesIf<Log>([frontRow](Candidate const &cand)
+                             { return cand.row != frontRow; },
+                             evDiscarded);
+    if constexpr (Log)
+        events.record({evListEnd});
+}
+
+/**
+ * @brief Construct a new Descision Pipeline:: Descision Pipeline object
+ *
+ * @param input InputStruct holding the input information
+ */
+DescisionPipeline::DescisionPipeline(InputStruct const *input) : DescisionPipeline(input, std::make_unique<CSVManager>(input->csvFile))
+{
+}
+
+/**
+ * @brief Pipeline owning <roster>. Changes of points are written to the CSV file of the roster by
+ * savePoints.
+ *
+ * @param input InputStruct holding the request
+ * @param roster loaded roster
+ */
+DescisionPipeline::DescisionPipeline(InputStruct const *input, std::unique_ptr<CSVManager> roster) : DescisionPipeline(input, *roster, std::move(roster))
+{
+}
+
+/**
+ * @brief Pipeline deciding on the given roster instead of the CSV file of <input>. The roster is
+ * borrowed, must outlive the pipeline and is never changed: points changed by decisions are kept
+ * in the pipeline (see getPoints) and savePoints writes nothing. Several pipelines may decide on
+ * the same roster concurrently.
+ *
+ * @param input InputStruct holding the request
+ * @param roster loaded roster
+ */
+DescisionPipeline::DescisionPipeline(InputStruct const *input, CSVManager const &roster) : DescisionPipeline(input, roster, std::unique_ptr<CSVManager>())
+{
+}
+
+/**
+ * @brief Pipeline deciding on the borrowed <roster> with other points than its own, e.g. those of a
+ * snapshot. Such decisions are never cached, as the roster version does not describe the points.
+ *
+ * @param input InputStruct holding the request
+ * @param roster loaded roster
+ * @param points points per roster position (must outlive the pipeline)
+ */
+DescisionPipeline::DescisionPipeline(InputStruct const *input, CSVManager const &roster, uint8_t const *points) : DescisionPipeline(input, roster, std::unique_ptr<CSVManager>())
+{
+    this->points = points;
+}
+
+/**
+ * @brief Pipeline deciding on <roster>, which is owned by the pipeline when <ownRoster> holds it
+ *
+ * @param input InputStruct holding the request
+ * @param roster roster decided on
+ * @param ownRoster roster owned by the pipeline or null
+ */
+DescisionPipeline::DescisionPipeline(InputStruct const *input, CSVManager const &roster, std::unique_ptr<CSVManager> &&ownRoster) : ownRoster(std::move(ownRoster)),
+                                                                                    csvMan(roster),
+                                                                                    points(roster.getPointsColumn().data()),
+                                                                                    input(input),
+                                                                                    plan(planToLoad(input)),
+                                                                                    scratchBuffer(scratchSizeFor(input)),
+                                                                                    scratchArena(scratchBuffer.data(), scratchBuffer.size()),
+                                                                                    candidates(&scratchArena),
+                                                                                    rng(std::random_device{}()),
+                                                                                    unavailable(csvMan.getStudentCount(), false),
+                                                                                    parallelThreads(input->threads ? input->threads : std::max(1u, std::thread::hardware_concurrency()))
+{
+    ScopedPhaseTimer timer(phaseSelection);
+    events.open(input->verbose, input->eventLogFile);
+    // positions of a saved plan are only valid for the students it was saved for
+    if (plan.isOpen() && plan.getLayoutHash() != csvMan.getLayoutHash())
+    {
+        std::cout << "WARNING - Seating plan \"" << input->planName << "\" was saved for other students. Save it again with save-plan.\n";
+        plan.close();
+    }
+    rowCount = plan.isOpen() ? plan.getRowCount() : selectionRowCount(input);
+    // seating table when seating row is considered
+    if (events.enabled() && rowCount > 1)
     {
-        auto row = input->studSelection.find(i);
-        if (row != input->studSelection.end())
-        { // check if row has value
-            studsInRow = row->second;
-            std::set_intersection(
-                studSelection.begin(), studSelection.end(),
-                studsInRow.begin(), studsInRow.end(),
-                std::inserter(priorizedStudsInRow, priorizedStudsInRow.begin())); // Inserter for Not-Read-Only Iterator
+        events.record({evSelectionHeader});
+        for (PlanEntry const &entry : plan)
+            events.record({evSelectionEntry, 0, entry.row, csvMan.getName(entry.stud)});
+        for (auto const &elem : input->studSelection)
+        {
+            for (auto const &name : elem.second)
+                events.record({evSelectionEntry, 0, elem.first, name});
+        }
+        for (auto const &elem : input->groupSelection)
+        {
+            for (auto const &group : elem.second)
+                events.record({evSelectionEntry, 0, elem.first, group});
         }
+        events.drain();
     }
 
-    if (input->verbose)
+    // saved plan: names resolved, ordered and unique already
+    for (PlanEntry const &entry : plan)
     {
-        puts("\nStudents of selection that sit furthest in front:");
-        listStrings(priorizedStudsInRow);
+        if (entry.stud < csvMan.getStudentCount())
+            selection.push_back({entry.stud, entry.row, 0});
     }
+    bool planned = plan.isOpen();
+    plan.close();
 
-    // discard all students not in priorizedStudsInRow (= studSelection - priorizedStudsInRow)
-    std::set<std::string> discardStuds;
-    std::string discardedStr;
-    std::set_difference(
-        studSelection.begin(), studSelection.end(),
-        priorizedStudsInRow.begin(), priorizedStudsInRow.end(),
-        std::inserter(discardStuds, discardStuds.begin())); // Inserter for Not-Read-Only Iterator
-    for (std::string studName : discardStuds)
+    // resolve names of selection (rows ascending)
+    for (auto const &studRow : input->studSelection)
     {
-        if (input->verbose)
-            discardedStr.append(studName + ", ");
-        studPriorizing.erase(studName);
+        for (std::string const &studName : studRow.second)
+        {
+            uint32_t stud = resolveStudent(studName);
+            if (stud != NO_STUDENT)
+                this->selection.push_back({stud, studRow.first, 0});
+        }
     }
-    if (input->verbose)
+    // whole groups straight from the roster index
+    for (auto const &groupRow : input->groupSelection)
     {
-        if (!discardedStr.empty())
+        for (std::string const &group : groupRow.second)
         {
-            discardedStr.pop_back(); // remove ' '
-            discardedStr.pop_back(); // remove ','
+            std::vector<uint32_t> const &members = csvMan.getGroupMembers(group);
+            if (members.empty())
+                std::cout << "Group \"" << group << "\" has no students.\n";
+            for (uint32_t stud : members)
+                this->selection.push_back({stud, groupRow.first, 0});
         }
-        std::cout << "Discarding all other students of selection\n\t" << discardedStr << "\n";
     }
+    // order by name; students listed in several rows keep their front row
+    if (!planned)
+    {
+        std::sort(selection.begin(), selection.end(), [this](Candidate const &a, Candidate const &b)
+                  {
+            int order = csvMan.getName(a.stud).compare(csvMan.getName(b.stud));
+            return order != 0 ? order < 0 : a.row < b.row; });
+        selection.erase(std::unique(selection.begin(), selection.end(), [](Candidate const &a, Candidate const &b)
+                                    { return a.stud == b.stud; }),
+                        selection.end());
+    }
+    // sort out excluded students
+    for (std::string const &studName : input->excludedStuds)
+    {
+        uint32_t stud = resolveStudent(studName);
+        selection.erase(std::remove_if(selection.begin(), selection.end(), [stud](Candidate const &cand)
+                                       { return cand.stud == stud; }),
+                        selection.end());
+    }
+
+    resetCandidates();
+    semCohort = parseCohortKey(input->semGroup);
+    if (semCohort == INVALID_COHORT && input->semGroup != "")
+        std::cout << "WARNING - Seminar group \"" << input->semGroup << "\" is not valid (expected format XYINB-Z).\n";
+    decideVariant = selectDecideVariant();
+    selectionHash = rowCount > 1; // rows are considered (fixed like decideVariant)
+    for (Candidate const &cand : selection)
+        selectionHash = hashCombine(hashCombine(selectionHash, cand.stud), (uint32_t)cand.row);
 }
 
 /**
- * @brief Construct a new Descision Pipeline:: Descision Pipeline object
+ * @brief Returns roster position of the chosen student, NO_STUDENT when there is nothing to decide
+ * on or only sorted out repeaters are selected (an error is printed then). Decides for one student by going through 3 phases of decisions. If there are several students
+ * left in the selection at the end, one is chosen at random. Every call decides on the whole
+ * selection again and does not allocate memory (unless diagnostics are enabled).
  *
- * @param input InputStruct holding the input information
+ * @return uint32_t
  */
-DescisionPipeline::DescisionPipeline(InputStruct const *input) : csvMan(CSVManager(input->csvFile)), input(input)
+uint32_t DescisionPipeline::decideForStudent()
 {
-    // verbose output when seating row is considered
-    if (input->verbose && input->studSelection.size() > 1)
-    {
-        std::cout << padTo("seating row", PADDING) << "| "
-                  << padTo("   name", PADDING - 1) << "\n"
-                  << padTo("", PADDING, '-') << "+" << padTo("", PADDING - 1, '-') << std::endl;
+    return (this->*decideVariant)();
+}
+
+/**
+ * @brief Reseeds the random decisions, so decisions can be reproduced
+ *
+ * @param seed seed of the random stream
+ */
+void DescisionPipeline::seedRandom(uint32_t seed)
+{
+    rng.seed(seed);
+}
 
-        for (auto elem : input->studSelection)
+/**
+ * @brief Sets from how many candidates on rule passes run in parallel and on how many threads.
+ * Results do not depend on it.
+ *
+ * @param threshold minimal number of candidates for parallel rule passes
+ * @param threads threads of parallel rule passes (0 = number of cores)
+ */
+void DescisionPipeline::setParallelism(size_t threshold, unsigned threads)
+{
+    parallelThreshold = threshold;
+    parallelThreads = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * @brief Decides for up to <count> distinct students one after another. Every chosen student gets
+ * a point (in memory, see savePoints) and leaves the selection for the following decisions. Only
+ * students present with probability <attendance> take part. Returns less students when the
+ * selection runs out.
+ *
+ * @param count number of students to decide for
+ * @param attendance probability of every student of the selection to be present
+ * @return std::vector<uint32_t>
+ */
+std::vector<uint32_t> DescisionPipeline::decideForStudents(size_t count, double attendance)
+{
+    std::vector<uint32_t> chosen;
+    size_t available = selection.size();
+    if (attendance < 1.0)
+    {
+        std::bernoulli_distribution present(attendance);
+        for (Candidate const &cand : selection)
         {
-            for (auto name : elem.second)
+            if (!present(rng))
             {
-                std::cout << padTo(to_string(elem.first), PADDING) << "| "
-                          << padTo(name, PADDING - 1) << std::endl;
+                setUnavailable(cand.stud, true);
+                available--;
             }
         }
     }
-
-    // create <map> from students
-    this->studPriorizing = {};
-    for (auto studRow : input->studSelection)
+    for (size_t i = 0; i < count && available > 0; i++)
     {
-        for (std::string studName : studRow.second)
-        {
-            // does given student exist?
-            if (csvMan.getStudent(studName) != nullptr)
-                this->studPriorizing.insert({studName, 0});
-            else
-                std::cout << "Student \"" << studName << "\" does not exist." << std::endl;
-        }
+        if (!hasEligibleStudents())
+            break;
+
+        uint32_t stud = decideForStudent();
+        if (stud == NO_STUDENT)
+            break;
+        chosen.push_back(stud);
+        adjustPoints(stud, true);
+        setUnavailable(stud, true);
+        available--;
     }
+    for (Candidate const &cand : selection)
+        setUnavailable(cand.stud, false);
+    resetCandidates();
+    return chosen;
+}
+
+/**
+ * @brief Returns true when a decision can choose a student: the selection has an available student
+ * that is not a sorted out repeater. Deciding otherwise reports an error and returns NO_STUDENT.
+ *
+ * @return bool
+ */
+bool DescisionPipeline::hasEligibleStudents() const
+{
+    bool removeRepeaters = repeaterMode() == repeatersRemoved;
+    return std::any_of(selection.begin(), selection.end(), [this, removeRepeaters](Candidate const &cand)
+                       { return !unavailable[cand.stud] && !(removeRepeaters && isRepeater(csvMan.getCohortKey(cand.stud), semCohort)); });
 }
 
 /**
- * @brief Returns pointer to student object. Decides for one student by going through 3 phases of
- * decisions. If there are several students left in the selection at the end, one is chosen at random.
+ * @brief Decision specialized on the configuration of the request, so rules do not check the
+ * configuration per student.
  *
- * @return Student*
+ * @tparam Log record events
+ * @tparam Repeaters handling of repeaters; anything but repeatersIgnored also priorizes the correct
+ * seminar group and requires a valid seminar group
+ * @tparam Rows consider seating rows
+ * @return uint32_t
  */
-Student *DescisionPipeline::decideForStudent()
+template <bool Log, RepeaterMode Repeaters, bool Rows>
+uint32_t DescisionPipeline::decide()
 {
-    if (studPriorizing.size() == 0)
+    if (selection.empty())
     {
+        resetCandidates();
         puts("ERROR: no valid selection of students");
-        return nullptr; // return nullptr when no students to decide
+        return NO_STUDENT; // no students to decide
     }
 
-    // First elimination phase
-    if (input->verbose)
-        puts("\n----------------- First sorting out --------------------");
-    if (input->allowRepeater == false)
+    // an identical request on the same roster content only needs the random pick; decisions with
+    // diagnostics, recorded phases, unavailable students or unsaved points are not cached. A hit
+    // repeats the warning of the filter stage, which follows from the request alone
+    DecisionRequest request;
+    bool cacheable = !Log && input->output == outputText && unavailableCount == 0 && !hasChangedPoints();
+    if (cacheable)
     {
-        try
+        request = decisionRequest();
+        if (std::shared_ptr<const CachedDecision> cached = DecisionCache::shared().find(request))
         {
-            removeRepeaters(input->semGroup);
-            if (studPriorizing.empty())
+            if constexpr (Repeaters == repeatersIgnored)
             {
-                puts("ERROR - Only repeaters are selected, but no repeaters are allowed.");
-                exit(0);
+                if (input->allowRepeater == false)
+                    puts(repeaterWarning);
             }
+            ScopedPhaseTimer timer(phaseFinalDecision);
+            restoreCandidates(cached->finalists);
+            decisionCount++;
+            return candidates.size() > 1 ? getRandomStudent() : candidates.front().stud;
+        }
+    }
+    resetCandidates();
+    recordPhaseCandidates(phaseSelection);
+
+    // lazy stage chain: rules only run while more than one candidate remains; the filters always
+    // run, as they decide whether the last candidate may be chosen at all
+    std::optional<ScopedPhaseTimer> phaseTimer;
+    MetricPhase openPhase = PHASE_COUNT;
+    uint8_t skipped = 0;
+    for (int stage = 0; stage < STAGE_COUNT; stage++)
+    {
+        if (!stageApplies<Repeaters, Rows>((DecisionStage)stage))
+            continue;
+        MetricPhase phase = stagePhases[stage];
+        if (stage != stageFilters && candidates.size() <= 1)
+        {
+            addPhaseSkippedStages(phase, 1);
+            skipped++;
+            continue;
+        }
+        if (phase != openPhase)
+        {
+            if (openPhase != PHASE_COUNT)
+                recordPhaseCandidates(openPhase);
+            phaseTimer.reset(); // close previous phase before opening the next one
+            phaseTimer.emplace(phase);
+            openPhase = phase;
+            if constexpr (Log)
+                events.record({evPhase, (uint8_t)(phase - phaseFirstSortingOut)});
         }
-        catch (std::out_of_range)
+        size_t before = candidates.size();
+        runStage<Log, Repeaters>((DecisionStage)stage);
+        if (stageRules[stage] != RULE_COUNT)
         {
-            puts("WARNING - Could not sort out repeaters, because the seminar group was not specified.");
+            selectivity[stageRules[stage]].evaluated += before;
+            selectivity[stageRules[stage]].removed += before - candidates.size();
         }
     }
-    rulePreferredPoints(input->preferredPoints);
+    if (openPhase != PHASE_COUNT)
+        recordPhaseCandidates(openPhase);
+    phaseTimer.reset();
+    decisionCount++;
+    if constexpr (Log)
+    {
+        if (skipped > 0)
+            events.record({evSettled, skipped});
+    }
 
-    // Prioritization phase
-    if (input->semGroup != "")
+    if (cacheable && !candidates.empty())
     {
-        if (input->verbose)
-            puts("\n----------------- Prioritization phase -----------------");
-        rulePriorizeCorrectSemGroup(input->semGroup, input->priorityCorrectSemGroup);
-        if (input->allowRepeater)
-            rulePriorizeRepeaters(input->semGroup, input->priorityRepeater);
+        auto decision = std::make_shared<CachedDecision>();
+        decision->request = request;
+        decision->finalists.assign(candidates.begin(), candidates.end());
+        DecisionCache::shared().insert(std::move(decision));
     }
 
-    // Second elimination phase
-    if (input->verbose)
-        puts("\n----------------- Second sorting out -------------------");
-    removeLeastPriorized();
-    // only if more than 1 row AND more than 1 stud remaining
-    if (input->studSelection.size() > 1 && studPriorizing.size() > 1)
-        ruleFurthestInFront();
+    if (candidates.empty()) // only repeaters selected, but repeaters are sorted out
+    {
+        if constexpr (Log)
+            events.drain();
+        return NO_STUDENT;
+    }
 
     // Final Decision
-    if (input->verbose)
-        puts("\n----------------- Final decision phase -----------------");
-    if (studPriorizing.size() > 1)
+    ScopedPhaseTimer timer(phaseFinalDecision);
+    if constexpr (Log)
+        events.record({evPhase, 3});
+    uint32_t chosenOne;
+    if (candidates.size() > 1)
+    {
+        if constexpr (Log)
+        {
+            events.record({evRemaining});
+            logListed();
+            events.record({evRandomPick});
+        }
+        chosenOne = getRandomStudent(); // random descision if more than 1 students now
+    }
+    else
+        chosenOne = candidates.front().stud; // return only remaining student
+    if constexpr (Log)
+        events.drain();
+    return chosenOne;
+}
+
+/**
+ * @brief Records the current candidates as candidates at the end of <phase> of the current decision,
+ * when the result is not printed as text
+ *
+ * @param phase phase of the decision
+ */
+void DescisionPipeline::recordPhaseCandidates(MetricPhase phase)
+{
+    if (input->output == outputText)
+        return;
+    PhaseCandidates &recorded = phaseCandidates.emplace_back();
+    recorded.decision = decisionCount;
+    recorded.phase = phase;
+    recorded.studs.reserve(candidates.size());
+    for (Candidate const &cand : candidates)
+        recorded.studs.push_back(cand.stud);
+}
+
+/**
+ * @brief Returns true when rule stage <stage> is part of decisions with the given configuration
+ *
+ * @tparam Repeaters handling of repeaters
+ * @tparam Rows consider seating rows
+ * @param stage rule stage
+ * @return bool
+ */
+template <RepeaterMode Repeaters, bool Rows>
+bool DescisionPipeline::stageApplies(DecisionStage stage) const
+{
+    switch (stage)
+    {
+    case stageFilters: // sort out, or warn that repeaters cannot be sorted out
+        return Repeaters == repeatersRemoved || (Repeaters == repeatersIgnored && input->allowRepeater == false) ||
+               unavailableCount > 0;
+    case stagePriorize:
+        return Repeaters != repeatersIgnored;
+    case stageFurthestInFront:
+        return Rows;
+    default:
+        return true;
+    }
+}
+
+/**
+ * @brief Runs rule stage <stage> of a decision on the candidates
+ *
+ * @tparam Log record events
+ * @tparam Repeaters handling of repeaters
+ * @param stage rule stage
+ */
+template <bool Log, RepeaterMode Repeaters>
+void DescisionPipeline::runStage(DecisionStage stage)
+{
+    switch (stage)
+    {
+    case stageFilters:
+        if constexpr (Repeaters == repeatersIgnored)
+        {
+            if (input->allowRepeater == false)
+            {
+                events.drain();
+                puts(repeaterWarning);
+            }
+        }
+        runFilters<Log, Repeaters>();
+        if (candidates.empty())
+        {
+            events.drain();
+            puts("ERROR - Only repeaters are selected, but no repeaters are allowed.");
+        }
+        break;
+    case stagePreferredPoints:
+        rulePreferredPoints<Log>(input->preferredPoints);
+        break;
+    case stagePriorize:
+        if constexpr (Repeaters != repeatersIgnored)
+        {
+            rulePriorizeCorrectSemGroup<Log>(semCohort, input->priorityCorrectSemGroup);
+            if constexpr (Repeaters == repeatersPriorized)
+                rulePriorizeRepeaters<Log>(semCohort, input->priorityRepeater);
+        }
+        break;
+    case stageRemoveLeastPriorized:
+        removeLeastPriorized<Log>();
+        break;
+    case stageFurthestInFront:
+        ruleFurthestInFront<Log>();
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Runs the filter rules in the order of their measured selectivity and cost. Filters only
+ * test every candidate on its own, so any order leaves the same candidates (in the same order).
+ *
+ * @tparam Log record events
+ * @tparam Repeaters handling of repeaters
+ */
+template <bool Log, RepeaterMode Repeaters>
+void DescisionPipeline::runFilters()
+{
+    for (DecisionRule filter : filterOrder)
     {
-        if (input->verbose)
+        size_t before = candidates.size();
+        if (filter == ruleRepeaters)
         {
-            puts("At least two students remain:");
-            listStrings(studPriorizing);
-            puts("--> Random pick of student\n");
+            if constexpr (Repeaters != repeatersRemoved)
+                continue;
+            removeRepeaters<Log>(semCohort);
         }
-        return csvMan.getStudent(getRandomStudent()); // random descision if more than 1 students now
+        else
+        {
+            if (unavailableCount == 0)
+                continue;
+            discardCandidatesIf<false>([this](Candidate const &cand)
+                                       { return unavailable[cand.stud]; },
+                                       evDiscarded);
+        }
+        selectivity[filter].evaluated += before;
+        selectivity[filter].removed += before - candidates.size();
+    }
+    reorderFilters();
+}
+
+/**
+ * @brief Orders the filter rules by removed candidates per cost, so the filter removing most
+ * candidates at least cost runs first and the following filters test less candidates.
+ *
+ */
+void DescisionPipeline::reorderFilters()
+{
+    auto rank = [this](DecisionRule filter)
+    {
+        RuleSelectivity const &stats = selectivity[filter];
+        double removedShare = stats.evaluated ? (double)stats.removed / stats.evaluated : 0;
+        return removedShare / filterCosts[filter];
+    };
+    // insertion sort: stable and without allocation (unlike std::stable_sort)
+    for (size_t i = 1; i < filterOrder.size(); i++)
+    {
+        for (size_t j = i; j > 0 && rank(filterOrder[j]) > rank(filterOrder[j - 1]); j--)
+            std::swap(filterOrder[j], filterOrder[j - 1]);
     }
-    return csvMan.getStudent(studPriorizing.begin()->first); // return only student in map
 }
 
 /**
- * @brief Increments point-score of every student of selection by 1
+ * @brief Marks student at roster position <stud> as unavailable for the following decisions or
+ * available again
+ *
+ * @param stud roster position
+ * @param isUnavailable unavailable when true
+ */
+void DescisionPipeline::setUnavailable(uint32_t stud, bool isUnavailable)
+{
+    if (unavailable[stud] == isUnavailable)
+        return;
+    unavailable[stud] = isUnavailable;
+    if (isUnavailable)
+        unavailableCount++;
+    else
+        unavailableCount--;
+}
+
+/**
+ * @brief Prints candidates evaluated and removed per rule and the current order of the filters
+ *
+ * @param out stream to print to
+ */
+void DescisionPipeline::printRuleSelectivity(std::ostream &out) const
+{
+    out << padTo("rule", 20) << padTo("evaluated", 12) << padTo("removed", 12) << "selectivity\n";
+    for (int rule = 0; rule < RULE_COUNT; rule++)
+    {
+        RuleSelectivity const &stats = selectivity[rule];
+        double removedShare = stats.evaluated ? (double)stats.removed / stats.evaluated : 0;
+        out << padTo(ruleNames[rule], 20) << padTo(std::to_string(stats.evaluated), 12)
+            << padTo(std::to_string(stats.removed), 12) << std::to_string(removedShare) << "\n";
+    }
+    out << "filter order:";
+    for (DecisionRule filter : filterOrder)
+        out << " " << ruleNames[filter];
+    out << std::endl;
+}
+
+/**
+ * @brief Returns the variant of decide() matching the configuration of the request
+ *
+ * @return DescisionPipeline::DecideVariant
+ */
+DescisionPipeline::DecideVariant DescisionPipeline::selectDecideVariant() const
+{
+    // [log][repeaters][rows]
+    static const DecideVariant variants[2][3][2] = {
+        {{&DescisionPipeline::decide<false, repeatersIgnored, false>, &DescisionPipeline::decide<false, repeatersIgnored, true>},
+         {&DescisionPipeline::decide<false, repeatersRemoved, false>, &DescisionPipeline::decide<false, repeatersRemoved, true>},
+         {&DescisionPipeline::decide<false, repeatersPriorized, false>, &DescisionPipeline::decide<false, repeatersPriorized, true>}},
+        {{&DescisionPipeline::decide<true, repeatersIgnored, false>, &DescisionPipeline::decide<true, repeatersIgnored, true>},
+         {&DescisionPipeline::decide<true, repeatersRemoved, false>, &DescisionPipeline::decide<true, repeatersRemoved, true>},
+         {&DescisionPipeline::decide<true, repeatersPriorized, false>, &DescisionPipeline::decide<true, repeatersPriorized, true>}}};
+
+    bool rows = rowCount > 1;
+    return variants[events.enabled()][repeaterMode()][rows];
+}
+
+/**
+ * @brief Returns handling of repeaters for the seminar group and options of the input
+ *
+ * @return RepeaterMode
+ */
+RepeaterMode DescisionPipeline::repeaterMode() const
+{
+    if (semCohort == INVALID_COHORT) // without seminar group neither priorizing nor sorting out
+        return repeatersIgnored;
+    return input->allowRepeater ? repeatersPriorized : repeatersRemoved;
+}
+
+/**
+ * @brief Returns rank score of candidate <cand> by the criteria of decideForStudent in the order
+ * they are applied: distance to the preferred points (students with less points first), priority,
+ * seating row and random tie-break. Lower score ranks higher.
+ *
+ * @param cand candidate to score
+ * @param repeaters handling of repeaters
+ * @return uint64_t
+ */
+uint64_t DescisionPipeline::rankScore(Candidate const &cand, RepeaterMode repeaters)
+{
+    uint8_t studPoints = points[cand.stud];
+    uint64_t pointsDistance = studPoints <= input->preferredPoints
+                                  ? input->preferredPoints - studPoints
+                                  : 256 + studPoints - input->preferredPoints; // only when no student has <= preferred points
+
+    uint8_t priority = 0;
+    if (repeaters != repeatersIgnored)
+    {
+        CohortKey studCohort = csvMan.getCohortKey(cand.stud);
+        if (studCohort == semCohort)
+            priority += input->priorityCorrectSemGroup;
+        if (repeaters == repeatersPriorized && isRepeater(studCohort, semCohort))
+            priority += input->priorityRepeater;
+    }
+
+    uint64_t row = std::clamp(cand.row, 0, RANK_ROW_MAX);
+    return (pointsDistance << RANK_POINTS_SHIFT) | ((uint64_t)(uint8_t)~priority << RANK_PRIORITY_SHIFT) |
+           (row << RANK_ROW_SHIFT) | (rng() & RANK_RANDOM_MASK);
+}
+
+/**
+ * @brief Returns the first <count> students of the selection in the order decideForStudent would
+ * choose them, when every chosen student left the selection. Ranks whole selection for <count> 0.
+ * Sorted out repeaters are not ranked.
+ *
+ * @param count number of students to rank
+ * @return std::vector<uint32_t>
+ */
+std::vector<uint32_t> DescisionPipeline::rankStudents(size_t count)
+{
+    RepeaterMode repeaters = repeaterMode();
+    if (repeaters == repeatersIgnored && input->allowRepeater == false)
+        puts(repeaterWarning);
+
+    // flat array of (score, roster position)
+    std::vector<std::pair<uint64_t, uint32_t>> scores;
+    scores.reserve(selection.size());
+    for (Candidate const &cand : selection)
+    {
+        if (repeaters == repeatersRemoved && isRepeater(csvMan.getCohortKey(cand.stud), semCohort))
+            continue;
+        scores.push_back({rankScore(cand, repeaters), cand.stud});
+    }
+
+    // select top <count> first, order only those
+    if (count == 0 || count > scores.size())
+        count = scores.size();
+    std::nth_element(scores.begin(), scores.begin() + count, scores.end());
+    std::sort(scores.begin(), scores.begin() + count);
+
+    std::vector<uint32_t> ranked;
+    ranked.reserve(count);
+    for (size_t i = 0; i < count; i++)
+        ranked.push_back(scores[i].second);
+    return ranked;
+}
+
+/**
+ * @brief Increments or decrements point-score of every student of selection by 1 and writes the CSV
+ * file once. Returns positions of the changed students.
+ *
+ * @param doIncrement increment when true, decrement otherwise
+ * @return std::vector<uint32_t>
+ */
+std::vector<uint32_t> DescisionPipeline::adjustPointsOfSelection(bool doIncrement)
+{
+    std::vector<uint32_t> changed;
+    changed.reserve(selection.size());
+    for (Candidate const &cand : selection)
+    {
+        adjustPoints(cand.stud, doIncrement);
+        changed.push_back(cand.stud);
+    }
+    savePoints();
+    return changed;
+}
+/**
+ * @brief Increments point-score of every student of selection by 1. The CSV file is written once.
  *
  */
 void DescisionPipeline::incrementPointsOfSelection()
 {
-    for (auto pair : studPriorizing)
-        csvMan.incrementPoints(pair.first);
+    for (uint32_t stud : adjustPointsOfSelection(true))
+        std::cout << csvMan.getName(stud) << " has now " << std::to_string(points[stud]) << " points\n";
 }
 /**
- * @brief Decrements point-score of every student of selection by 1
+ * @brief Decrements point-score of every student of selection by 1. The CSV file is written once.
  *
  */
 void DescisionPipeline::decrementPointsOfSelection()
 {
-    for (auto pair : studPriorizing)
-        csvMan.decrementPoints(pair.first);
+    for (uint32_t stud : adjustPointsOfSelection(false))
+        std::cout << csvMan.getName(stud) << " has now " << std::to_string(points[stud]) << " points\n";
+}
+/**
+ * @brief Writes points changed by previous decisions to the CSV file. Returns false when the file
+ * was not written or the roster is borrowed.
+ *
+ * @return bool
+ */
+bool DescisionPipeline::savePoints()
+{
+    return ownRoster && ownRoster->saveChanges();
 }
 
 /**
- * @brief Returns copy of given string padded to given num. When <str> is already bigger than num,
- * nothing happens.
+ * @brief Increments or decrements points of student at roster position <stud>. A borrowed roster is
+ * not changed: its points are copied into the pipeline on the first change.
  *
- * @param str string to pad
- * @param num size for string
- * @param paddingChar char to pad with
- * @return std::string
+ * @param stud roster position
+ * @param doIncrement increment when true, decrement otherwise
  */
-std::string padTo(std::string const &str, const size_t num, const char paddingChar)
+void DescisionPipeline::adjustPoints(uint32_t stud, bool doIncrement)
 {
-    std::string padStr = str;
-    if (num > padStr.size())
-        padStr.insert(padStr.end(), num - padStr.size(), paddingChar);
-    return padStr;
+    if (ownRoster)
+    {
+        ownRoster->adjustPoints(stud, doIncrement);
+        return;
+    }
+    if (pointsCopy.empty())
+    {
+        pointsCopy.assign(points, points + csvMan.getStudentCount());
+        points = pointsCopy.data();
+    }
+    if (doIncrement)
+        pointsCopy[stud]++;
+    else if (pointsCopy[stud] > 0)
+        pointsCopy[stud]--;
 }
+
+/**
+ * @brief Returns true when the points decided on differ from the content of the roster version, so
+ * decisions cannot be cached under it
+ *
+ * @return bool
+ */
+bool DescisionPipeline::hasChangedPoints() const
+{
+    return csvMan.hasUnsavedPoints() || points != csvMan.getPointsColumn().data();
+}
+
+/**
+ * @brief Returns the version of the loaded roster
+ *
+ * @return uint64_t
+ */
+uint64_t DescisionPipeline::getRosterVersion()
+{
+    return csvMan.getVersion();
+}
+
+/**
+ * @brief Returns roster positions of the valid students of the selection
+ *
+ * @return std::vector<uint32_t>
+ */
+std::vector<uint32_t> DescisionPipeline::getSelectedStudents() const
+{
+    std::vector<uint32_t> students;
+    students.reserve(selection.size());
+    for (Candidate const &cand : selection)
+        students.push_back(cand.stud);
+    return students;
+}
+
+/**
+ * @brief Saves the valid students of the selection with their seating rows as seating plan
+ * <filename> for the current students of the roster. Returns true when the plan was written.
+ *
+ * @param filename file of the plan
+ * @return bool
+ */
+bool DescisionPipeline::saveSeatingPlan(std::string const &filename) const
+{
+    std::vector<PlanEntry> entries;
+    entries.reserve(selection.size());
+    for (Candidate const &cand : selection)
+        entries.push_back({cand.stud, cand.row});
+    return SeatingPlan::save(filename, csvMan.getLayoutHash(), rowCount, entries);
+}
+
+// Rules without events, called directly by tests
+template void DescisionPipeline::rulePreferredPoints<false>(uint8_t);
+template void DescisionPipeline::rulePriorizeCorrectSemGroup<false>(CohortKey, uint8_t);
+template void DescisionPipeline::rulePriorizeRepeaters<false>(CohortKey, uint8_t);
+template void DescisionPipeline::ruleFurthestInFront<false>();
+template void DescisionPipeline::removeLeastPriorized<false>();
+template size_t DescisionPipeline::closestLEQPoints<false>(uint8_t &);
+template size_t DescisionPipeline::closestGEQPoints<false>(uint8_t &);
+template void DescisionPipeline::runFilters<false, repeatersRemoved>();
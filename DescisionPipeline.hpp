@@ -1,38 +1,210 @@
 #pragma once
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <ostream>
+#include <random>
 #include <string>
-#include <map>
+#include <vector>
 #include "InputStruct.hpp"
 #include "CSVManager.hpp"
+#include "EventLog.hpp"
+#include "Metrics.hpp"
+#include "SeatingPlan.hpp"
+
+struct DecisionRequest;
+
+/**
+ * @brief Student of the selection with its seating row and 'priorize value'
+ */
+struct Candidate
+{
+    uint32_t stud; // position in roster
+    int row;
+    uint8_t priority;
+};
+
+/**
+ * @brief Enumeration of the handling of repeaters in a decision
+ */
+enum RepeaterMode
+{
+    repeatersIgnored,  // no seminar group given
+    repeatersRemoved,  // repeaters are sorted out
+    repeatersPriorized // repeaters are priorized
+};
+
+/**
+ * @brief Rule stages of a decision in the order they run
+ */
+enum DecisionStage
+{
+    stageFilters,              // sort out unavailable students and repeaters
+    stagePreferredPoints,      // keep students closest to the preferred points
+    stagePriorize,             // priorize correct seminar group and repeaters
+    stageRemoveLeastPriorized, // keep students with max priority
+    stageFurthestInFront,      // keep students furthest in front
+    STAGE_COUNT
+};
+
+/**
+ * @brief Rules removing candidates, counted for selectivity. The first FILTER_RULE_COUNT rules are
+ * pure filters, which commute; all other rules select by the remaining candidates and keep their order.
+ */
+enum DecisionRule
+{
+    ruleUnavailable, // filter: absent or already chosen students
+    ruleRepeaters,   // filter: repeaters
+    rulePoints,      // closest to preferred points
+    ruleMaxPriority, // max priority
+    ruleFrontRow,    // furthest in front
+    RULE_COUNT
+};
+
+#define FILTER_RULE_COUNT 2
+#define PARALLEL_CANDIDATE_THRESHOLD 16384 // below, rule passes stay on the calling thread
+#define PARALLEL_MAX_PARTS 64              // maximal threads of a rule pass
+
+/**
+ * @brief Candidates a rule was applied to and removed
+ */
+struct RuleSelectivity
+{
+    uint64_t evaluated = 0;
+    uint64_t removed = 0;
+};
+
+/**
+ * @brief Candidates left at the end of a phase of a decision
+ */
+struct PhaseCandidates
+{
+    uint32_t decision;           // number of the decision of the pipeline (from 0)
+    MetricPhase phase;           // phaseSelection for the candidates a decision starts with
+    std::vector<uint32_t> studs; // positions in roster
+};
 
 class DescisionPipeline
 {
     friend class DescisionPipelineTest;
 
 private:
-    CSVManager csvMan;
+    using DecideVariant = uint32_t (DescisionPipeline::*)();
+
+    std::unique_ptr<CSVManager> ownRoster;              // roster loaded by the pipeline; null when borrowed
+    CSVManager const &csvMan;                          // roster decided on (read only)
+    uint8_t const *points;                             // points per roster position: column of the roster or pointsCopy
+    std::vector<uint8_t> pointsCopy;                   // points changed by a pipeline on a borrowed roster
     InputStruct const *input;
-    std::map<std::string, uint8_t> studPriorizing; // Map students on a 'priorize value'
+    SeatingPlan plan;                                  // saved seating plan of input; mapped until the selection is built
+    std::vector<std::byte> scratchBuffer;              // storage of scratchArena
+    std::pmr::monotonic_buffer_resource scratchArena;  // scratch memory of a decision; released between decisions
+    std::vector<Candidate> selection;                  // valid students of selection (ordered by name)
+    std::pmr::vector<Candidate> candidates;            // remaining students of current decision (in scratchArena)
+    std::array<uint32_t, 256> pointsHistogram;         // number of candidates per amount of points
+    EventLog events;                                   // diagnostics, formatted when drained
+    CohortKey semCohort;                               // parsed seminar group of input
 
-    std::set<std::string> closestLEQPointsStudents(uint8_t leqPoints, std::map<std::string, uint8_t> studs);
-    std::set<std::string> closestGEQPointsStudents(uint8_t geqPoints, std::map<std::string, uint8_t> studs);
+    DecideVariant decideVariant;                       // decide() specialized on the configuration
+    std::mt19937 rng;                                  // random decisions; own stream per pipeline
+    std::vector<bool> unavailable;                     // per roster position: absent or already chosen
+    size_t unavailableCount = 0;
+    std::array<RuleSelectivity, RULE_COUNT> selectivity{};
+    std::array<DecisionRule, FILTER_RULE_COUNT> filterOrder = {ruleUnavailable, ruleRepeaters}; // adapted to selectivity
+    size_t parallelThreshold = PARALLEL_CANDIDATE_THRESHOLD; // candidates from which rule passes run on several threads
+    unsigned parallelThreads;                                // threads of parallel rule passes
+    std::vector<PhaseCandidates> phaseCandidates;            // recorded for machine-readable output only
+    uint64_t selectionHash = 0;                              // part of the decision cache key
+    size_t rowCount = 0;                                     // number of seating rows of the selection
+    uint32_t decisionCount = 0;
+
+    DescisionPipeline(InputStruct const *input, std::unique_ptr<CSVManager> roster);
+    DescisionPipeline(InputStruct const *input, CSVManager const &roster, std::unique_ptr<CSVManager> &&ownRoster);
+    size_t scratchSizeFor(InputStruct const *input) const;
+    unsigned candidateParts() const;
+    template <typename Pass>
+    void forEachCandidatePart(unsigned parts, Pass pass);
+    uint32_t resolveStudent(std::string const &studName);
+    template <bool Log, typename Predicate>
+    void discardCandidatesIf(Predicate discard, DecisionEventType eventType);
+    void resetCandidates();
+    void restoreCandidates(std::vector<Candidate> const &cached);
+    DecisionRequest decisionRequest() const;
+    void fillPointsHistogram();
+    template <bool Log>
+    size_t closestLEQPoints(uint8_t &leqPoints);
+    template <bool Log>
+    size_t closestGEQPoints(uint8_t &geqPoints);
     uint8_t getMaxPriorizing();
+    template <bool Log>
     void removeLessPriorizedThen(uint8_t priorizeValue);
+    template <bool Log>
     void removeLeastPriorized();
-    void removeRepeaters(std::string semGroup);
-    std::string getRandomStudent();
-    void listStrings(std::set<std::string> const &listingSet);
-    void listStrings(std::map<std::string, uint8_t> const &listingMap);
+    template <bool Log>
+    void removeRepeaters(CohortKey semCohort);
+    uint32_t getRandomStudent();
+    void logListed();
+    void logListedWithPoints(uint8_t points);
 
+    template <bool Log>
     void rulePreferredPoints(uint8_t preferredPoints);
-    void rulePriorizeCorrectSemGroup(std::string semGroup, uint8_t priorityValue);
-    void rulePriorizeRepeaters(std::string semGroup, uint8_t priorityValue);
+    template <bool Log>
+    void rulePriorizeCorrectSemGroup(CohortKey semCohort, uint8_t priorityValue);
+    template <bool Log>
+    void rulePriorizeRepeaters(CohortKey semCohort, uint8_t priorityValue);
+    template <bool Log>
     void ruleFurthestInFront();
 
+    template <RepeaterMode Repeaters, bool Rows>
+    bool stageApplies(DecisionStage stage) const;
+    template <bool Log, RepeaterMode Repeaters>
+    void runStage(DecisionStage stage);
+    template <bool Log, RepeaterMode Repeaters>
+    void runFilters();
+    void reorderFilters();
+    void recordPhaseCandidates(MetricPhase phase);
+    void setUnavailable(uint32_t stud, bool isUnavailable);
+    void adjustPoints(uint32_t stud, bool doIncrement);
+    bool hasChangedPoints() const;
+    template <bool Log, RepeaterMode Repeaters, bool Rows>
+    uint32_t decide();
+    RepeaterMode repeaterMode() const;
+    DecideVariant selectDecideVariant() const;
+    uint64_t rankScore(Candidate const &cand, RepeaterMode repeaters);
+
 public:
     DescisionPipeline(InputStruct const *input);
-    Student *decideForStudent();
+    DescisionPipeline(InputStruct const *input, CSVManager const &roster);
+    DescisionPipeline(InputStruct const *input, CSVManager const &roster, uint8_t const *points);
+    void seedRandom(uint32_t seed);
+    void setParallelism(size_t threshold, unsigned threads);
+    bool hasEligibleStudents() const;
+    uint32_t decideForStudent();
+    std::vector<uint32_t> decideForStudents(size_t count, double attendance = 1.0);
+    std::vector<uint32_t> rankStudents(size_t count);
+    std::vector<uint32_t> adjustPointsOfSelection(bool doIncrement);
     void incrementPointsOfSelection();
     void decrementPointsOfSelection();
+    bool savePoints();
+    uint64_t getRosterVersion();
+    std::vector<uint32_t> getSelectedStudents() const;
+    bool saveSeatingPlan(std::string const &filename) const;
+    /**
+     * @brief Returns candidates rule <rule> was applied to and removed by all decisions so far
+     */
+    RuleSelectivity const &getRuleSelectivity(DecisionRule rule) const { return selectivity[rule]; }
+    void printRuleSelectivity(std::ostream &out) const;
+    /**
+     * @brief Returns candidates per phase of all decisions so far (recorded for output other than text)
+     */
+    std::vector<PhaseCandidates> const &getPhaseCandidates() const { return phaseCandidates; }
+    /**
+     * @brief Returns the roster the pipeline decides on
+     */
+    CSVManager const &getRoster() const { return csvMan; }
+    /**
+     * @brief Returns points of student at roster position <stud> including changes by the pipeline
+     */
+    uint8_t getPoints(uint32_t stud) const { return points[stud]; }
 };
-
-std::string padTo(std::string const &str, const size_t num, const char paddingChar = ' ');
@@ -0,0 +1,250 @@
+#include <iostream>
+#include "EventLog.hpp"
+
+#define PADDING 15
+
+/**
+ * @brief Names of the events in JSON lines
+ */
+static const char *const eventNames[] = {
+    "selection_header",
+    "selection_entry",
+    "phase",
+    "preferred_points",
+    "points_search",
+    "no_leq_found",
+    "listed",
+    "discard_others",
+    "discard_less_priority",
+    "discarded",
+    "list_end",
+    "repeater_removed",
+    "correct_sem_group",
+    "repeater_priorized",
+    "max_priority",
+    "furthest_in_front",
+    "remaining",
+    "random_pick",
+    "settled"};
+
+/**
+ * @brief Headlines of the decision phases
+ */
+static const char *const phaseHeadlines[] = {
+    "\n----------------- First sorting out --------------------\n",
+    "\n----------------- Prioritization phase -----------------\n",
+    "\n----------------- Second sorting out -------------------\n",
+    "\n----------------- Final decision phase -----------------\n"};
+
+/**
+ * @brief Returns copy of given string padded to given num. When <str> is already bigger than num,
+ * nothing happens.
+ *
+ * @param str string to pad
+ * @param num size for string
+ * @param paddingChar char to pad with
+ * @return std::string
+ */
+std::string padTo(std::string const &str, const size_t num, const char paddingChar)
+{
+    std::string padStr = str;
+    if (num > padStr.size())
+        padStr.insert(padStr.end(), num - padStr.size(), paddingChar);
+    return padStr;
+}
+
+/**
+ * @brief Appends <str> to <out> as JSON string; control characters are escaped as \u00XX
+ *
+ * @param out string to append to
+ * @param str string to escape
+ */
+void appendJSONString(std::string &out, std::string_view str)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    out.push_back('"');
+    for (char c : str)
+    {
+        if ((unsigned char)c < 0x20)
+        {
+            out += "\\u00";
+            out.push_back(hexDigits[(unsigned char)c >> 4]);
+            out.push_back(hexDigits[c & 0xf]);
+            continue;
+        }
+        if (c == '"' || c == '\\')
+            out.push_back('\\');
+        out.push_back(c);
+    }
+    out.push_back('"');
+}
+
+EventLog::EventLog(size_t capacity) : ring(capacity)
+{
+}
+
+EventLog::~EventLog()
+{
+    close();
+}
+
+/**
+ * @brief Enables sinks of the log
+ *
+ * @param text format events as text to stdout
+ * @param jsonFile append events as JSON lines to this file; empty for none
+ */
+void EventLog::open(bool text, std::string const &jsonFile)
+{
+    textSink = text;
+    if (!jsonFile.empty())
+    {
+        jsonSink = fopen(jsonFile.c_str(), "a");
+        if (!jsonSink)
+            std::cerr << "Error:\tCould not open event log \"" << jsonFile << "\"" << std::endl;
+    }
+}
+
+/**
+ * @brief Drains remaining events and closes the sinks
+ *
+ */
+void EventLog::close()
+{
+    drain();
+    if (jsonSink)
+        fclose(jsonSink);
+    jsonSink = nullptr;
+    textSink = false;
+}
+
+/**
+ * @brief Formats all buffered events and writes them to the sinks
+ *
+ */
+void EventLog::drain()
+{
+    if (count == 0)
+        return;
+    textBuffer.clear();
+    jsonBuffer.clear();
+    for (; count > 0; count--)
+    {
+        DecisionEvent const &event = ring[head];
+        if (textSink)
+            formatText(event);
+        if (jsonSink)
+            formatJSON(event);
+        head = (head + 1) % ring.size();
+    }
+    if (textSink)
+    {
+        fwrite(textBuffer.data(), 1, textBuffer.size(), stdout);
+    }
+    if (jsonSink)
+    {
+        fwrite(jsonBuffer.data(), 1, jsonBuffer.size(), jsonSink);
+        fflush(jsonSink);
+    }
+}
+
+/**
+ * @brief Appends text of event to the text buffer
+ *
+ * @param event event to format
+ */
+void EventLog::formatText(DecisionEvent const &event)
+{
+    std::string &out = textBuffer;
+    std::string value = std::to_string(event.value);
+    switch (event.type)
+    {
+    case evSelectionHeader:
+        out += padTo("seating row", PADDING) + "| " + padTo("   name", PADDING - 1) + "\n" +
+               padTo("", PADDING, '-') + "+" + padTo("", PADDING - 1, '-') + "\n";
+        break;
+    case evSelectionEntry:
+        out += padTo(std::to_string(event.row), PADDING) + "| " + padTo(std::string(event.name), PADDING - 1) + "\n";
+        break;
+    case evPhase:
+        out += phaseHeadlines[event.value];
+        break;
+    case evPreferredPoints:
+        out += "preferred points: " + value + "\n";
+        break;
+    case evPointsSearch:
+        out += "Searching for students with " + value + " points";
+        out += event.row > 0 ? "\t- found:\n" : "\t- no student found\n";
+        break;
+    case evNoLEQFound:
+        out += "\nNo student with <= " + value + " points found.\nSearching for students with > " + value + " points\n";
+        break;
+    case evListed:
+        out += "\t";
+        out += event.name;
+        out += "\n";
+        break;
+    case evDiscardOthers:
+        out += "Discarding all other students of selection\n\t";
+        listFirst = true;
+        break;
+    case evDiscardLessPriority:
+        out += "Discarding students with less than " + value + " priority\n\t";
+        listFirst = true;
+        break;
+    case evDiscarded:
+        if (!listFirst)
+            out += ", ";
+        out += event.name;
+        listFirst = false;
+        break;
+    case evListEnd:
+        out += "\n";
+        break;
+    case evRepeaterRemoved:
+        out += "Removing repeater \t";
+        out += event.name;
+        out += "\n";
+        break;
+    case evCorrectSemGroup:
+        out += padTo(std::string(event.name), PADDING) + "\tis in correct seminar\t- priorize by " + value + "\n";
+        break;
+    case evRepeaterPriorized:
+        out += padTo(std::string(event.name), PADDING) + "\tseems to be repeater\t- priorize by " + value + "\n";
+        break;
+    case evMaxPriority:
+        out += "Max priorize-value: " + value + "\n";
+        break;
+    case evFurthestInFront:
+        out += "\nStudents of selection that sit furthest in front:\n";
+        break;
+    case evRemaining:
+        out += "At least two students remain:\n";
+        break;
+    case evRandomPick:
+        out += "--> Random pick of student\n\n";
+        break;
+    case evSettled:
+        out += "Decision settled, skipping " + std::to_string(event.value) + " remaining rule(s)\n";
+        break;
+    }
+}
+
+/**
+ * @brief Appends event as JSON line to the JSON buffer
+ *
+ * @param event event to format
+ */
+void EventLog::formatJSON(DecisionEvent const &event)
+{
+    std::string &out = jsonBuffer;
+    out += "{\"event\":\"";
+    out += eventNames[event.type];
+    out += "\",\"value\":" + std::to_string(event.value) + ",\"row\":" + std::to_string(event.row);
+    if (!event.name.empty())
+    {
+        out += ",\"student\":";
+        appendJSONString(out, event.name);
+    }
+    out += "}\n";
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#define EVENT_LOG_CAPACITY 1024
+
+/**
+ * @brief Enumeration of events of a decision
+ */
+enum DecisionEventType
+{
+    evSelectionHeader,     // header of seating table
+    evSelectionEntry,      // name in seating row <row>
+    evPhase,               // start of phase <value>
+    evPreferredPoints,     // preferred points <value>
+    evPointsSearch,        // search for <value> points found <row> students
+    evNoLEQFound,          // no student with <= <value> points
+    evListed,              // <student> is listed
+    evDiscardOthers,       // start of list of discarded students
+    evDiscardLessPriority, // start of list of students with less than <value> priority
+    evDiscarded,           // <student> is discarded
+    evListEnd,             // end of list of discarded students
+    evRepeaterRemoved,     // <student> is removed as repeater
+    evCorrectSemGroup,     // <student> is priorized by <value> for correct seminar group
+    evRepeaterPriorized,   // <student> is priorized by <value> as repeater
+    evMaxPriority,         // max priority <value>
+    evFurthestInFront,     // start of list of students furthest in front
+    evRemaining,           // start of list of remaining students
+    evRandomPick,          // student is picked randomly
+    evSettled              // decision settled, <value> rule stages skipped
+};
+
+/**
+ * @brief Structured event. Formatting is deferred until the event is drained.
+ */
+struct DecisionEvent
+{
+    DecisionEventType type = evPhase;
+    uint8_t value = 0;
+    int row = 0;
+    std::string_view name = {}; // name of the student or selection entry (must outlive the log)
+};
+
+/**
+ * @brief Preallocated buffer of decision events. Events are formatted when drained: as text to
+ * stdout and/or as JSON lines to a file.
+ */
+class EventLog
+{
+private:
+    std::vector<DecisionEvent> ring;
+    size_t head = 0;
+    size_t count = 0;
+    bool textSink = false;
+    FILE *jsonSink = nullptr;
+    std::string textBuffer;
+    std::string jsonBuffer;
+    bool listFirst = true; // formatting state: next listed name is the first of its list
+
+    void formatText(DecisionEvent const &event);
+    void formatJSON(DecisionEvent const &event);
+
+public:
+    EventLog(size_t capacity = EVENT_LOG_CAPACITY);
+    ~EventLog();
+    EventLog(EventLog const &) = delete;
+    EventLog &operator=(EventLog const &) = delete;
+    void open(bool text, std::string const &jsonFile);
+    void close();
+    /**
+     * @brief Returns true when events are recorded
+     */
+    bool enabled() const { return textSink || jsonSink; }
+    /**
+     * @brief Records event. Drains the buffer when it is full.
+     */
+    void record(DecisionEvent const &event)
+    {
+        if (count == ring.size())
+            drain();
+        ring[(head + count) % ring.size()] = event;
+        count++;
+    }
+    void drain();
+};
+
+void appendJSONString(std::string &out, std::string_view str);
+std::string padTo(std::string const &str, const size_t num, const char paddingChar = ' ');
@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <map>
+#include <set>
 #include <string>
 
 #define CSVFILE "students.csv"
@@ -13,7 +14,21 @@ enum ProgramCommand
     unhandled,
     decision,
     increment,
-    decrement
+    decrement,
+    ranking,
+    simulation,
+    planSaving
+};
+
+/**
+ * @brief Enumeration of the formats of the result of a command
+ */
+enum OutputFormat
+{
+    outputText,  // sentences for people
+    outputJSON,  // one JSON object per call
+    outputTSV,   // tab-separated lines, record ends with an empty line
+    outputBinary // length-prefixed record (see OutputRecord.hpp)
 };
 
 /**
@@ -26,11 +41,29 @@ struct InputStruct
     ProgramCommand state = unhandled;
 
     bool verbose = false;
+    OutputFormat output = outputText;
+    std::string eventLogFile = ""; // append decision events as JSON lines to this file when set
     bool allowRepeater = true;
+    bool autoResolve = false;   // replace unknown names by an unambiguous similar name of the roster
     uint8_t preferredPoints = 0;
     uint8_t priorityCorrectSemGroup = 2;
     uint8_t priorityRepeater = 1;
     std::string semGroup = "";
+    size_t rankCount = 0;       // number of students to rank (0 = whole selection)
+    size_t pickCount = 1;       // number of distinct students to decide for
+    bool commitPoints = false;  // write points of chosen students to the CSV file
+    double attendance = 1.0;    // probability of a student of the selection to be present
+    size_t simSessions = 30;    // sessions per simulated semester
+    size_t simRuns = 1000;      // simulated semesters
+    unsigned threads = 0;       // threads of the simulation and of large decisions (0 = number of cores)
+    int64_t simSeed = -1;       // seed of the simulation (-1 = random)
+    std::string traceFile = ""; // record program calls to this file when set
+    bool stats = false;         // report metrics of the call
+    std::string statsFile = ""; // write metrics to this file when set
+
+    std::string planName = "";  // saved seating plan to decide on (name of the plan to save for save-plan)
 
     std::map<int, std::set<std::string>> studSelection;
+    std::map<int, std::set<std::string>> groupSelection; // whole seminar groups (XYINB-Z) or cohort years (XY) per row
+    std::set<std::string> excludedStuds;                 // students sorted out of the selection
 };
@@ -0,0 +1,287 @@
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include "Metrics.hpp"
+
+/**
+ * @brief Names of the phases as used in reports
+ */
+static const char *const phaseNames[PHASE_COUNT] = {
+    "csv_load",
+    "selection",
+    "first_sorting_out",
+    "prioritization",
+    "second_sorting_out",
+    "final_decision",
+    "csv_write"};
+
+/**
+ * @brief Adds the counters of <metric> to <total>
+ */
+static void addPhaseMetric(PhaseMetric &total, PhaseMetric const &metric)
+{
+    total.calls += metric.calls;
+    total.nanos += metric.nanos;
+    total.allocations += metric.allocations;
+    total.allocatedBytes += metric.allocatedBytes;
+    total.ioBytes += metric.ioBytes;
+    total.skippedStages += metric.skippedStages;
+}
+
+// phase metrics of all threads that exited, e.g. workers of simulations
+static std::mutex exitedMutex;
+static PhaseMetric exitedMetrics[PHASE_COUNT];
+
+/**
+ * @brief Phase metrics of one thread, added to the metrics of exited threads when the thread exits
+ */
+struct ThreadMetrics
+{
+    PhaseMetric phases[PHASE_COUNT];
+
+    ~ThreadMetrics()
+    {
+        std::lock_guard<std::mutex> lock(exitedMutex);
+        for (int i = 0; i < PHASE_COUNT; i++)
+            addPhaseMetric(exitedMetrics[i], phases[i]);
+    }
+};
+
+// Counters are per thread, so counting needs no synchronization
+static thread_local uint64_t allocationCount = 0;
+static thread_local uint64_t allocatedBytes = 0;
+static thread_local ThreadMetrics threadMetrics;
+
+/**
+ * @brief Counts an allocation of <size> bytes by the calling thread. Called by the counting
+ * operator new of AllocationCounter.cpp; without it allocations are reported as 0.
+ *
+ * @param size requested bytes
+ */
+void countAllocation(std::size_t size)
+{
+    allocationCount++;
+    allocatedBytes += size;
+}
+
+ScopedPhaseTimer::ScopedPhaseTimer(MetricPhase phase) : phase(phase),
+                                                        start(std::chrono::steady_clock::now()),
+                                                        startAllocations(allocationCount),
+                                                        startAllocatedBytes(allocatedBytes)
+{
+}
+
+ScopedPhaseTimer::~ScopedPhaseTimer()
+{
+    PhaseMetric &metric = threadMetrics.phases[phase];
+    metric.calls++;
+    metric.nanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    metric.allocations += allocationCount - startAllocations;
+    metric.allocatedBytes += allocatedBytes - startAllocatedBytes;
+}
+
+/**
+ * @brief Returns number of allocations of the calling thread so far
+ *
+ * @return uint64_t
+ */
+uint64_t getAllocationCount()
+{
+    return allocationCount;
+}
+
+/**
+ * @brief Returns number of allocated bytes of the calling thread so far
+ *
+ * @return uint64_t
+ */
+uint64_t getAllocatedBytes()
+{
+    return allocatedBytes;
+}
+
+/**
+ * @brief Returns the metric of the given phase of the calling thread
+ *
+ * @param phase measured phase
+ * @return PhaseMetric const&
+ */
+PhaseMetric const &getPhaseMetric(MetricPhase phase)
+{
+    return threadMetrics.phases[phase];
+}
+
+/**
+ * @brief Returns the metric of the given phase of the calling thread and all threads that exited
+ *
+ * @param phase measured phase
+ * @return PhaseMetric
+ */
+PhaseMetric getTotalPhaseMetric(MetricPhase phase)
+{
+    PhaseMetric total = threadMetrics.phases[phase];
+    std::lock_guard<std::mutex> lock(exitedMutex);
+    addPhaseMetric(total, exitedMetrics[phase]);
+    return total;
+}
+
+/**
+ * @brief Returns name of the given phase as used in reports
+ *
+ * @param phase measured phase
+ * @return const char*
+ */
+const char *getPhaseName(MetricPhase phase)
+{
+    return phaseNames[phase];
+}
+
+/**
+ * @brief Adds read or written bytes to the metric of the given phase
+ *
+ * @param phase measured phase
+ * @param bytes number of bytes
+ */
+void addPhaseIOBytes(MetricPhase phase, uint64_t bytes)
+{
+    threadMetrics.phases[phase].ioBytes += bytes;
+}
+
+/**
+ * @brief Adds rule stages skipped because the decision was already settled to the metric of the
+ * given phase
+ *
+ * @param phase phase of the skipped stages
+ * @param stages number of skipped stages
+ */
+void addPhaseSkippedStages(MetricPhase phase, uint64_t stages)
+{
+    threadMetrics.phases[phase].skippedStages += stages;
+}
+
+/**
+ * @brief Resets all phase metrics of the calling thread and of threads that exited
+ *
+ */
+void resetMetrics()
+{
+    for (PhaseMetric &metric : threadMetrics.phases)
+        metric = PhaseMetric();
+    std::lock_guard<std::mutex> lock(exitedMutex);
+    for (PhaseMetric &metric : exitedMetrics)
+        metric = PhaseMetric();
+}
+
+/**
+ * @brief Prints a table of all phase metrics of the calling thread and all threads that exited
+ *
+ * @param out stream to print to
+ */
+void printMetricsSummary(std::ostream &out)
+{
+    out << std::left << std::setw(20) << "phase"
+        << std::right << std::setw(8) << "calls"
+        << std::setw(12) << "time [us]"
+        << std::setw(10) << "allocs"
+        << std::setw(14) << "alloc [byte]"
+        << std::setw(12) << "io [byte]"
+        << std::setw(9) << "skipped" << "\n";
+    for (int i = 0; i < PHASE_COUNT; i++)
+    {
+        PhaseMetric metric = getTotalPhaseMetric((MetricPhase)i);
+        if (metric.calls == 0 && metric.skippedStages == 0)
+            continue;
+        out << std::left << std::setw(20) << phaseNames[i]
+            << std::right << std::setw(8) << metric.calls
+            << std::setw(12) << std::fixed << std::setprecision(1) << metric.nanos / 1000.0
+            << std::setw(10) << metric.allocations
+            << std::setw(14) << metric.allocatedBytes
+            << std::setw(12) << metric.ioBytes
+            << std::setw(9) << metric.skippedStages << "\n";
+    }
+    out.flush();
+}
+
+/**
+ * @brief Writes all phase metrics of the calling thread and all threads that exited as JSON object
+ *
+ * @param out stream to write to
+ */
+void writeMetricsJSON(std::ostream &out)
+{
+    out << "{\"phases\":[";
+    for (int i = 0; i < PHASE_COUNT; i++)
+    {
+        PhaseMetric metric = getTotalPhaseMetric((MetricPhase)i);
+        if (i > 0)
+            out << ",";
+        out << "{\"name\":\"" << phaseNames[i] << "\""
+            << ",\"calls\":" << metric.calls
+            << ",\"nanoseconds\":" << metric.nanos
+            << ",\"allocations\":" << metric.allocations
+            << ",\"allocated_bytes\":" << metric.allocatedBytes
+            << ",\"io_bytes\":" << metric.ioBytes
+            << ",\"skipped_stages\":" << metric.skippedStages << "}";
+    }
+    out << "]}\n";
+}
+
+/**
+ * @brief Writes all phase metrics of the calling thread and all threads that exited in Prometheus
+ * text format
+ *
+ * @param out stream to write to
+ */
+void writeMetricsPrometheus(std::ostream &out)
+{
+    const struct
+    {
+        const char *name;
+        const char *help;
+        uint64_t PhaseMetric::*field;
+    } counters[] = {
+        {"decision_helper_phase_calls_total", "Number of executions of the phase.", &PhaseMetric::calls},
+        {"decision_helper_phase_nanoseconds_total", "Wall time spent in the phase.", &PhaseMetric::nanos},
+        {"decision_helper_phase_allocations_total", "Heap allocations in the phase.", &PhaseMetric::allocations},
+        {"decision_helper_phase_allocated_bytes_total", "Heap bytes allocated in the phase.", &PhaseMetric::allocatedBytes},
+        {"decision_helper_phase_io_bytes_total", "Bytes read or written in the phase.", &PhaseMetric::ioBytes},
+        {"decision_helper_phase_skipped_stages_total", "Rule stages of the phase skipped after the decision was settled.", &PhaseMetric::skippedStages}};
+    PhaseMetric totals[PHASE_COUNT];
+    for (int i = 0; i < PHASE_COUNT; i++)
+        totals[i] = getTotalPhaseMetric((MetricPhase)i);
+
+    for (auto const &counter : counters)
+    {
+        out << "# HELP " << counter.name << " " << counter.help << "\n"
+            << "# TYPE " << counter.name << " counter\n";
+        for (int i = 0; i < PHASE_COUNT; i++)
+            out << counter.name << "{phase=\"" << phaseNames[i] << "\"} " << totals[i].*counter.field << "\n";
+    }
+}
+
+/**
+ * @brief Prints summary of metrics to stderr. When <metricsFile> is given, metrics are written to it
+ * as JSON (ending '.json') or in Prometheus text format (otherwise).
+ *
+ * @param metricsFile name of file for metrics; empty for none
+ */
+void reportMetrics(std::string const &metricsFile)
+{
+    printMetricsSummary(std::cerr);
+    if (metricsFile.empty())
+        return;
+
+    std::ofstream metricsStream(metricsFile);
+    if (!metricsStream)
+    {
+        std::cerr << "Error:\tCould not open metrics file \"" << metricsFile << "\"" << std::endl;
+        return;
+    }
+    const std::string jsonEnding = ".json";
+    if (metricsFile.size() >= jsonEnding.size() &&
+        metricsFile.compare(metricsFile.size() - jsonEnding.size(), jsonEnding.size(), jsonEnding) == 0)
+        writeMetricsJSON(metricsStream);
+    else
+        writeMetricsPrometheus(metricsStream);
+}
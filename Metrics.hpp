@@ -0,0 +1,66 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+ * @brief Enumeration of the measured phases of a program call
+ */
+enum MetricPhase
+{
+    phaseCSVLoad,
+    phaseSelection,
+    phaseFirstSortingOut,
+    phasePrioritization,
+    phaseSecondSortingOut,
+    phaseFinalDecision,
+    phaseCSVWrite,
+    PHASE_COUNT
+};
+
+/**
+ * @brief Accumulated measurements of one phase
+ */
+struct PhaseMetric
+{
+    uint64_t calls = 0;
+    uint64_t nanos = 0;          // wall time
+    uint64_t allocations = 0;    // calls of operator new (0 without AllocationCounter.cpp)
+    uint64_t allocatedBytes = 0; // bytes requested by operator new (0 without AllocationCounter.cpp)
+    uint64_t ioBytes = 0;        // bytes read or written
+    uint64_t skippedStages = 0;  // rule stages not run because the decision was settled
+};
+
+/**
+ * @brief Measures time and allocations from construction to destruction and adds them to the
+ * metric of the given phase. Metrics are kept per thread and added to a process total when the
+ * thread exits.
+ */
+class ScopedPhaseTimer
+{
+private:
+    MetricPhase phase;
+    std::chrono::steady_clock::time_point start;
+    uint64_t startAllocations;
+    uint64_t startAllocatedBytes;
+
+public:
+    ScopedPhaseTimer(MetricPhase phase);
+    ~ScopedPhaseTimer();
+};
+
+void countAllocation(std::size_t size);
+uint64_t getAllocationCount();
+uint64_t getAllocatedBytes();
+PhaseMetric const &getPhaseMetric(MetricPhase phase);
+PhaseMetric getTotalPhaseMetric(MetricPhase phase);
+const char *getPhaseName(MetricPhase phase);
+void addPhaseIOBytes(MetricPhase phase, uint64_t bytes);
+void addPhaseSkippedStages(MetricPhase phase, uint64_t stages);
+void resetMetrics();
+void printMetricsSummary(std::ostream &out);
+void writeMetricsJSON(std::ostream &out);
+void writeMetricsPrometheus(std::ostream &out);
+void reportMetrics(std::string const &metricsFile);
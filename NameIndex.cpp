@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cctype>
+#include "NameIndex.hpp"
+
+/**
+ * @brief Returns the distinct trigrams of <name> (case-insensitive, padded with two spaces in front
+ * and one behind, so beginnings of names weigh more), packed into integers and sorted.
+ *
+ * @param name name of student
+ * @return std::vector<uint32_t>
+ */
+static std::vector<uint32_t> trigramsOf(std::string_view name)
+{
+    std::string padded = "  ";
+    padded.append(name).push_back(' ');
+    std::vector<uint32_t> trigrams;
+    trigrams.reserve(padded.size() - 2);
+    for (size_t i = 0; i + 2 < padded.size(); i++)
+    {
+        trigrams.push_back((uint32_t)std::tolower((unsigned char)padded[i]) << 16 |
+                           (uint32_t)std::tolower((unsigned char)padded[i + 1]) << 8 |
+                           (uint32_t)std::tolower((unsigned char)padded[i + 2]));
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+/**
+ * @brief Indexes the trigrams of <names>. Trigram and position pairs are sorted once into
+ * contiguous postings instead of growing a list per trigram.
+ *
+ * @param names name per position in the roster (empty names are not indexed)
+ */
+void NameIndex::build(std::vector<std::string_view> const &names)
+{
+    clear();
+    trigramCounts.assign(names.size(), 0);
+    std::vector<uint64_t> pairs; // trigram << 32 | position
+    pairs.reserve(names.size() * 12);
+    for (uint32_t i = 0; i < names.size(); i++)
+    {
+        if (names[i].empty())
+            continue;
+        std::vector<uint32_t> nameTrigrams = trigramsOf(names[i]);
+        trigramCounts[i] = std::min<size_t>(nameTrigrams.size(), UINT16_MAX);
+        for (uint32_t trigram : nameTrigrams)
+            pairs.push_back((uint64_t)trigram << 32 | i);
+    }
+    std::sort(pairs.begin(), pairs.end());
+
+    postings.reserve(pairs.size());
+    for (uint64_t pair : pairs)
+    {
+        uint32_t trigram = pair >> 32;
+        if (trigrams.empty() || trigrams.back() != trigram)
+        {
+            trigrams.push_back(trigram);
+            offsets.push_back(postings.size());
+        }
+        postings.push_back((uint32_t)pair);
+    }
+    offsets.push_back(postings.size());
+    built = true;
+}
+
+/**
+ * @brief Drops the index, e.g. after names of the roster changed
+ *
+ */
+void NameIndex::clear()
+{
+    trigrams.clear();
+    offsets.clear();
+    postings.clear();
+    trigramCounts.clear();
+    built = false;
+}
+
+/**
+ * @brief Returns up to <maxMatches> students whose names are at least <minSimilarity> similar to
+ * <name>, most similar first (ties by position in roster). Only students sharing a trigram with
+ * <name> are visited; the lookup touches no memory per student of the roster.
+ *
+ * @param name searched name
+ * @param maxMatches maximal number of matches
+ * @param minSimilarity minimal similarity of a match
+ * @return std::vector<NameMatch>
+ */
+std::vector<NameMatch> NameIndex::findSimilar(std::string const &name, size_t maxMatches, double minSimilarity) const
+{
+    // shared trigrams per position; kept zeroed between lookups, so only visited positions are reset
+    // (per thread, as indexes are shared between threads)
+    static thread_local std::vector<uint16_t> shared;
+    if (shared.size() < trigramCounts.size())
+        shared.resize(trigramCounts.size());
+    std::vector<uint32_t> nameTrigrams = trigramsOf(name);
+    std::vector<uint32_t> visited;
+    for (uint32_t trigram : nameTrigrams)
+    {
+        auto it = std::lower_bound(trigrams.begin(), trigrams.end(), trigram);
+        if (it == trigrams.end() || *it != trigram)
+            continue;
+        size_t i = it - trigrams.begin();
+        for (uint32_t p = offsets[i]; p < offsets[i + 1]; p++)
+        {
+            if (shared[postings[p]]++ == 0)
+                visited.push_back(postings[p]);
+        }
+    }
+
+    std::vector<NameMatch> matches;
+    for (uint32_t stud : visited)
+    {
+        double similarity = (double)shared[stud] / (nameTrigrams.size() + trigramCounts[stud] - shared[stud]);
+        if (similarity >= minSimilarity)
+            matches.push_back({stud, similarity});
+        shared[stud] = 0;
+    }
+    auto moreSimilar = [](NameMatch const &a, NameMatch const &b)
+    { return a.similarity != b.similarity ? a.similarity > b.similarity : a.stud < b.stud; };
+    if (matches.size() > maxMatches)
+    {
+        std::nth_element(matches.begin(), matches.begin() + maxMatches, matches.end(), moreSimilar);
+        matches.resize(maxMatches);
+    }
+    std::sort(matches.begin(), matches.end(), moreSimilar);
+    return matches;
+}
+
+/**
+ * @brief Returns bytes of the buffers of the index
+ *
+ * @return size_t
+ */
+size_t NameIndex::memoryFootprint() const
+{
+    return trigrams.capacity() * sizeof(uint32_t) + offsets.capacity() * sizeof(uint32_t) +
+           postings.capacity() * sizeof(uint32_t) + trigramCounts.capacity() * sizeof(uint16_t);
+}
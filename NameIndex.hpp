@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#define SIMILAR_NAME_THRESHOLD 0.3 // minimum similarity of a suggested name
+
+/**
+ * @brief Student of the roster with a name similar to a searched name
+ */
+struct NameMatch
+{
+    uint32_t stud;     // position in roster
+    double similarity; // shared trigrams / all trigrams of both names (1 = same trigrams)
+};
+
+/**
+ * @brief Trigram index over the names of a roster. A lookup only visits students sharing at least
+ * one trigram with the searched name instead of comparing against every name of the roster.
+ */
+class NameIndex
+{
+private:
+    std::vector<uint32_t> trigrams;      // distinct trigrams of all names (sorted)
+    std::vector<uint32_t> offsets;       // postings of trigrams[i] are postings[offsets[i]] to postings[offsets[i + 1]]
+    std::vector<uint32_t> postings;      // positions of students per trigram (ascending)
+    std::vector<uint16_t> trigramCounts; // distinct trigrams per position in roster (0 = not indexed)
+    bool built = false;
+
+public:
+    void build(std::vector<std::string_view> const &names);
+    void clear();
+    /**
+     * @brief Returns true when the index is built for the current names of the roster
+     */
+    bool isBuilt() const { return built; }
+    std::vector<NameMatch> findSimilar(std::string const &name, size_t maxMatches,
+                                       double minSimilarity = SIMILAR_NAME_THRESHOLD) const;
+    size_t memoryFootprint() const;
+};
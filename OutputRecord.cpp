@@ -0,0 +1,213 @@
+#include <cerrno>
+#include <unistd.h>
+#include "OutputRecord.hpp"
+
+/**
+ * @brief Names of the commands in records
+ */
+static const char *const commandNames[] = {
+    "unhandled",
+    "decide",
+    "add",
+    "sub",
+    "rank",
+    "simulate",
+    "save-plan"};
+
+/**
+ * @brief Returns output format named <format> (text, json, tsv or binary), -1 when unknown
+ *
+ * @param format name of format
+ * @return int
+ */
+int parseOutputFormat(std::string const &format)
+{
+    if (format == "text")
+        return outputText;
+    if (format == "json")
+        return outputJSON;
+    if (format == "tsv")
+        return outputTSV;
+    if (format == "binary")
+        return outputBinary;
+    return -1;
+}
+
+/**
+ * @brief Appends <value> with <bytes> bytes little-endian to <out>
+ *
+ * @param out buffer to append to
+ * @param value value
+ * @param bytes number of bytes
+ */
+static void appendLittleEndian(std::string &out, uint64_t value, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; i++)
+        out.push_back((char)(value >> (8 * i)));
+}
+
+/**
+ * @brief Appends <str> with u32 length prefix to <out>. Names of a roster always fit, as all its
+ * names together are limited to 4 GiB.
+ *
+ * @param out buffer to append to
+ * @param str string
+ */
+static void appendBinaryString(std::string &out, std::string_view str)
+{
+    appendLittleEndian(out, str.size(), 4);
+    out.append(str.data(), str.size());
+}
+
+/**
+ * @brief Appends names of students <studs> as JSON array to <out>
+ *
+ * @param out buffer to append to
+ * @param studs positions in roster
+ * @param roster roster of the students
+ */
+static void appendJSONNames(std::string &out, std::vector<uint32_t> const &studs, CSVManager const &roster)
+{
+    out.push_back('[');
+    for (size_t i = 0; i < studs.size(); i++)
+    {
+        if (i > 0)
+            out.push_back(',');
+        appendJSONString(out, roster.getName(studs[i]));
+    }
+    out.push_back(']');
+}
+
+/**
+ * @brief Formats <record> as one JSON object in one line
+ */
+static std::string formatJSON(OutputRecord const &record, CSVManager const &roster)
+{
+    std::string out = "{\"command\":\"";
+    out.append(commandNames[record.command]).append("\",\"chosen\":");
+    appendJSONNames(out, record.chosen, roster);
+    out.append(",\"phases\":[");
+    for (size_t i = 0; i < record.phases.size(); i++)
+    {
+        PhaseCandidates const &phase = record.phases[i];
+        out.append(i > 0 ? ",{\"decision\":" : "{\"decision\":").append(std::to_string(phase.decision));
+        out.append(",\"phase\":\"").append(getPhaseName(phase.phase)).append("\",\"candidates\":");
+        appendJSONNames(out, phase.studs, roster);
+        out.push_back('}');
+    }
+    out.append("],\"points\":[");
+    for (size_t i = 0; i < record.changedPoints.size(); i++)
+    {
+        uint32_t stud = record.changedPoints[i];
+        out.append(i > 0 ? ",{\"name\":" : "{\"name\":");
+        appendJSONString(out, roster.getName(stud));
+        out.append(",\"points\":").append(std::to_string(roster.getPoints(stud))).push_back('}');
+    }
+    out.append("]}\n");
+    return out;
+}
+
+/**
+ * @brief Formats <record> as tab-separated lines: "command", "chosen", "candidates" (decision,
+ * phase, names) and "points" lines, terminated by an empty line
+ */
+static std::string formatTSV(OutputRecord const &record, CSVManager const &roster)
+{
+    std::string out = "command\t";
+    out.append(commandNames[record.command]).push_back('\n');
+    for (uint32_t stud : record.chosen)
+        out.append("chosen\t").append(roster.getName(stud)).push_back('\n');
+    for (PhaseCandidates const &phase : record.phases)
+    {
+        out.append("candidates\t").append(std::to_string(phase.decision)).append("\t").append(getPhaseName(phase.phase));
+        for (uint32_t stud : phase.studs)
+            out.append("\t").append(roster.getName(stud));
+        out.push_back('\n');
+    }
+    for (uint32_t stud : record.changedPoints)
+    {
+        out.append("points\t").append(roster.getName(stud)).append("\t").append(std::to_string(roster.getPoints(stud))).push_back('\n');
+    }
+    out.push_back('\n');
+    return out;
+}
+
+/**
+ * @brief Formats <record> in the binary layout described in OutputRecord.hpp
+ */
+static std::string formatBinary(OutputRecord const &record, CSVManager const &roster)
+{
+    std::string body;
+    appendLittleEndian(body, record.command, 1);
+    appendLittleEndian(body, record.chosen.size(), 4);
+    for (uint32_t stud : record.chosen)
+        appendBinaryString(body, roster.getName(stud));
+    appendLittleEndian(body, record.phases.size(), 4);
+    for (PhaseCandidates const &phase : record.phases)
+    {
+        appendLittleEndian(body, phase.decision, 4);
+        appendLittleEndian(body, phase.phase, 1);
+        appendLittleEndian(body, phase.studs.size(), 4);
+        for (uint32_t stud : phase.studs)
+            appendBinaryString(body, roster.getName(stud));
+    }
+    appendLittleEndian(body, record.changedPoints.size(), 4);
+    for (uint32_t stud : record.changedPoints)
+    {
+        appendBinaryString(body, roster.getName(stud));
+        appendLittleEndian(body, roster.getPoints(stud), 1);
+    }
+
+    std::string out = OUTPUT_BINARY_MAGIC;
+    out.push_back(OUTPUT_BINARY_VERSION);
+    appendLittleEndian(out, body.size(), 4);
+    return out.append(body);
+}
+
+/**
+ * @brief Formats <record> as one buffer in <format>
+ *
+ * @param record result of the command
+ * @param roster roster the positions of the record refer to
+ * @param format output format other than text
+ * @return std::string
+ */
+std::string formatRecord(OutputRecord const &record, CSVManager const &roster, OutputFormat format)
+{
+    switch (format)
+    {
+    case outputJSON:
+        return formatJSON(record, roster);
+    case outputTSV:
+        return formatTSV(record, roster);
+    case outputBinary:
+        return formatBinary(record, roster);
+    default:
+        return "";
+    }
+}
+
+/**
+ * @brief Writes formatted record to descriptor <fd> at once (no flush per line). Returns false
+ * when writing failed.
+ *
+ * @param fd descriptor to write to
+ * @param formatted formatted record
+ * @return bool
+ */
+bool writeRecord(int fd, std::string const &formatted)
+{
+    size_t written = 0;
+    while (written < formatted.size())
+    {
+        ssize_t result = write(fd, formatted.data() + written, formatted.size() - written);
+        if (result < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        written += result;
+    }
+    return true;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "InputStruct.hpp"
+#include "DescisionPipeline.hpp"
+
+#define OUTPUT_BINARY_MAGIC "DHR"
+#define OUTPUT_BINARY_VERSION 2 // 2: strings with u32 length
+
+/**
+ * @brief Result of a command for machine-readable output. Students are positions in the roster.
+ *
+ * Binary layout (integers little-endian, strings as u32 length and bytes):
+ * "DHR" u8 version | u32 length of the rest | u8 command |
+ * u32 count, count * string chosen |
+ * u32 count, count * (u32 decision, u8 phase, u32 count, count * string candidate) |
+ * u32 count, count * (string name, u8 points)
+ */
+struct OutputRecord
+{
+    ProgramCommand command = unhandled;
+    std::vector<uint32_t> chosen;         // decided students (decide) or ranked students (rank)
+    std::vector<PhaseCandidates> phases;  // candidates per phase of every decision
+    std::vector<uint32_t> changedPoints;  // students whose points were changed and written
+};
+
+int parseOutputFormat(std::string const &format);
+std::string formatRecord(OutputRecord const &record, CSVManager const &roster, OutputFormat format);
+bool writeRecord(int fd, std::string const &formatted);
@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <regex>
+#include "ReferencePipeline.hpp"
+
+/**
+ * @brief Returns true when <semGroup> is a valid seminar group (XYINB-Z: 2 digits year, 1 to 3
+ * capital letters program, group number up to 255). Checked on the strings, independent of the
+ * cohort keys of the optimized pipeline.
+ *
+ * @param semGroup seminar group
+ * @return bool
+ */
+static bool isValidSemGroup(std::string const &semGroup)
+{
+    static const std::regex format("[0-9]{2}[A-Z]{1,3}-([0-9]{1,3})");
+    std::smatch match;
+    return std::regex_match(semGroup, match, format) && std::stoi(match[1]) <= 255;
+}
+
+/**
+ * @brief Returns true when student with seminar group <semGroup> belongs to <group>: the same
+ * seminar group (XYINB-Z) or a seminar group of the cohort year (XY)
+ *
+ * @param semGroup seminar group of student
+ * @param group seminar group or cohort year
+ * @return bool
+ */
+static bool belongsTo(std::string const &semGroup, std::string const &group)
+{
+    static const std::regex year("[0-9]{2}");
+    if (!isValidSemGroup(semGroup))
+        return false;
+    if (std::regex_match(group, year))
+        return semGroup.substr(0, 2) == group;
+    return semGroup == group;
+}
+
+/**
+ * @brief Reference pipeline on <roster>. The selection holds every named student and every member
+ * of a selected group once, in the front-most row it was listed in, without excluded students.
+ *
+ * @param input InputStruct holding the request
+ * @param roster loaded roster
+ */
+ReferencePipeline::ReferencePipeline(InputStruct const *input, CSVManager const &roster) : input(input), rng(std::random_device{}())
+{
+    std::vector<ReferenceCandidate> listed;
+    for (auto const &studRow : input->studSelection)
+    {
+        for (std::string const &name : studRow.second)
+        {
+            for (uint32_t i = 0; i < roster.getStudentCount(); i++)
+            {
+                if (roster.getName(i) == name)
+                {
+                    listed.push_back({name, roster.getSemGroup(i), roster.getPoints(i), studRow.first, 0});
+                    break;
+                }
+            }
+        }
+    }
+    for (auto const &groupRow : input->groupSelection)
+    {
+        for (std::string const &group : groupRow.second)
+        {
+            for (uint32_t i = 0; i < roster.getStudentCount(); i++)
+            {
+                if (belongsTo(roster.getSemGroup(i), group))
+                    listed.push_back({std::string(roster.getName(i)), roster.getSemGroup(i), roster.getPoints(i), groupRow.first, 0});
+            }
+        }
+    }
+    for (ReferenceCandidate const &cand : listed)
+    {
+        if (input->excludedStuds.count(cand.name))
+            continue;
+        auto known = std::find_if(selection.begin(), selection.end(), [&cand](ReferenceCandidate const &other)
+                                  { return other.name == cand.name; });
+        if (known == selection.end())
+            selection.push_back(cand);
+        else
+            known->row = std::min(known->row, cand.row);
+    }
+    std::sort(selection.begin(), selection.end(), [](ReferenceCandidate const &a, ReferenceCandidate const &b)
+              { return a.name < b.name; });
+}
+
+/**
+ * @brief Reseeds the random decisions
+ *
+ * @param seed seed of the random stream
+ */
+void ReferencePipeline::seedRandom(uint32_t seed)
+{
+    rng.seed(seed);
+}
+
+/**
+ * @brief Returns true when <cand> is a repeater of the seminar group of the input
+ *
+ * @param cand candidate
+ * @return bool
+ */
+bool ReferencePipeline::isRepeater(ReferenceCandidate const &cand) const
+{
+    return isValidSemGroup(cand.semGroup) && cand.semGroup.substr(0, 2) != input->semGroup.substr(0, 2);
+}
+
+/**
+ * @brief Returns true when repeaters are sorted out and the selection holds nothing else
+ *
+ * @return bool
+ */
+bool ReferencePipeline::onlyRepeatersSelected() const
+{
+    if (!isValidSemGroup(input->semGroup) || input->allowRepeater)
+        return false;
+    return std::all_of(selection.begin(), selection.end(), [this](ReferenceCandidate const &cand)
+                       { return isRepeater(cand); });
+}
+
+/**
+ * @brief Records the current candidates as candidates at the end of <phase>
+ *
+ * @param phase phase of the decision
+ */
+void ReferencePipeline::recordPhase(MetricPhase phase)
+{
+    ReferencePhase &recorded = phases.emplace_back();
+    recorded.phase = phase;
+    for (ReferenceCandidate const &cand : candidates)
+        recorded.names.push_back(cand.name);
+}
+
+/**
+ * @brief Decides for a student of the selection by the rules of DescisionPipeline::decideForStudent.
+ * Returns empty name when the selection is empty.
+ *
+ * @return std::string
+ */
+std::string ReferencePipeline::decideForStudent()
+{
+    phases.clear();
+    candidates = selection;
+    if (candidates.empty())
+        return "";
+    recordPhase(phaseSelection);
+    bool semGroupValid = isValidSemGroup(input->semGroup);
+    auto keepIf = [this](auto keep)
+    {
+        std::vector<ReferenceCandidate> kept;
+        for (ReferenceCandidate const &cand : candidates)
+        {
+            if (keep(cand))
+                kept.push_back(cand);
+        }
+        candidates = kept;
+    };
+
+    // first sorting out: repeaters, then students with the closest points <= preferred points,
+    // otherwise the closest points above
+    if (semGroupValid && !input->allowRepeater)
+        keepIf([this](ReferenceCandidate const &cand)
+               { return !isRepeater(cand); });
+    int remainingPoints = -1;
+    for (int points = input->preferredPoints; points >= 0 && remainingPoints == -1; points--)
+    {
+        for (ReferenceCandidate const &cand : candidates)
+            remainingPoints = cand.points == points ? points : remainingPoints;
+    }
+    for (int points = input->preferredPoints + 1; points <= 255 && remainingPoints == -1; points++)
+    {
+        for (ReferenceCandidate const &cand : candidates)
+            remainingPoints = cand.points == points ? points : remainingPoints;
+    }
+    keepIf([remainingPoints](ReferenceCandidate const &cand)
+           { return cand.points == remainingPoints; });
+    recordPhase(phaseFirstSortingOut);
+    if (candidates.empty())
+        return ""; // only repeaters selected
+
+    // prioritization
+    if (semGroupValid)
+    {
+        for (ReferenceCandidate &cand : candidates)
+        {
+            if (cand.semGroup == input->semGroup)
+                cand.priority += input->priorityCorrectSemGroup;
+            if (input->allowRepeater && isRepeater(cand))
+                cand.priority += input->priorityRepeater;
+        }
+    }
+    recordPhase(phasePrioritization);
+
+    // second sorting out: highest priority, then front-most row
+    int maxPriority = 0;
+    for (ReferenceCandidate const &cand : candidates)
+        maxPriority = std::max(maxPriority, cand.priority);
+    keepIf([maxPriority](ReferenceCandidate const &cand)
+           { return cand.priority == maxPriority; });
+    int frontRow = candidates.front().row;
+    for (ReferenceCandidate const &cand : candidates)
+        frontRow = std::min(frontRow, cand.row);
+    keepIf([frontRow](ReferenceCandidate const &cand)
+           { return cand.row == frontRow; });
+    recordPhase(phaseSecondSortingOut);
+
+    if (candidates.size() == 1)
+        return candidates.front().name;
+    std::uniform_int_distribution<size_t> pick(0, candidates.size() - 1);
+    return candidates[pick(rng)].name;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <random>
+#include <string>
+#include <vector>
+#include "InputStruct.hpp"
+#include "CSVManager.hpp"
+#include "Metrics.hpp"
+
+/**
+ * @brief Candidates left at the end of a phase of a reference decision
+ */
+struct ReferencePhase
+{
+    MetricPhase phase;
+    std::vector<std::string> names; // ordered by name
+};
+
+/**
+ * @brief Straightforward implementation of the decision rules without indexes, arenas, stage
+ * skipping or parallel passes. Only for tests: optimized pipelines are checked against it.
+ */
+class ReferencePipeline
+{
+private:
+    /**
+     * @brief Student of the selection with everything the rules look at
+     */
+    struct ReferenceCandidate
+    {
+        std::string name;
+        std::string semGroup;
+        int points;
+        int row;
+        int priority;
+    };
+
+    InputStruct const *input;
+    std::vector<ReferenceCandidate> selection;
+    std::vector<ReferenceCandidate> candidates;
+    std::vector<ReferencePhase> phases;
+    std::mt19937 rng;
+
+    void recordPhase(MetricPhase phase);
+    bool isRepeater(ReferenceCandidate const &cand) const;
+
+public:
+    ReferencePipeline(InputStruct const *input, CSVManager const &roster);
+    void seedRandom(uint32_t seed);
+    std::string decideForStudent();
+    bool onlyRepeatersSelected() const;
+    /**
+     * @brief Returns candidates per phase of the last decision
+     */
+    std::vector<ReferencePhase> const &getPhases() const { return phases; }
+};
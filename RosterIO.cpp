@@ -0,0 +1,527 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include "RosterIO.hpp"
+
+#ifdef DECISION_IO_URING
+#include <cstdint>
+#include <initializer_list>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#define IO_CHUNK_SIZE (1 << 20) // bytes per read or write request
+#define RING_ENTRIES 64
+#define FILE_MODE 0644
+#define TEMP_SUFFIX ".tmp" // files are written next to their final name and renamed into place
+
+/**
+ * @brief Opens <filename> for reading and sets <size> to its size. Returns -1 when the file cannot
+ * be opened.
+ *
+ * @param filename name of file
+ * @param size set to size of file
+ * @return int file descriptor
+ */
+static int openForRead(std::string const &filename, size_t &size)
+{
+    int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    size = fileStat.st_size;
+    return fd;
+}
+
+/**
+ * @brief Reads whole file <filename> with blocking reads
+ *
+ * @param filename name of file
+ * @return FileContent
+ */
+static FileContent posixRead(std::string const &filename)
+{
+    FileContent file;
+    size_t size = 0;
+    int fd = openForRead(filename, size);
+    if (fd < 0)
+        return file;
+    file.found = true;
+    file.content.resize(size);
+    size_t done = 0;
+    while (done < size)
+    {
+        ssize_t bytes = read(fd, &file.content[done], size - done);
+        if (bytes < 0 && errno == EINTR)
+            continue;
+        if (bytes <= 0)
+            break;
+        done += bytes;
+    }
+    file.content.resize(done);
+    close(fd);
+    return file;
+}
+
+/**
+ * @brief Writes <content> to file <filename> with blocking writes followed by fsync
+ *
+ * @param filename name of file
+ * @param content new content
+ * @return bool true when the content is on disk
+ */
+static bool posixWrite(std::string const &filename, std::string const &content)
+{
+    int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, FILE_MODE);
+    if (fd < 0)
+        return false;
+    size_t done = 0;
+    while (done < content.size())
+    {
+        ssize_t bytes = write(fd, content.data() + done, content.size() - done);
+        if (bytes < 0 && errno == EINTR)
+            continue;
+        if (bytes <= 0)
+            break;
+        done += bytes;
+    }
+    bool written = done == content.size() && fsync(fd) == 0;
+    return close(fd) == 0 && written;
+}
+
+#ifdef DECISION_IO_URING
+/**
+ * @brief Submission and completion ring of io_uring, set up with raw system calls. Not ready when
+ * the kernel does not provide io_uring (or it is forbidden); callers fall back to POSIX then.
+ */
+class IoRing
+{
+private:
+    int fd = -1;
+    void *sqRing = MAP_FAILED;
+    void *cqRing = MAP_FAILED;
+    io_uring_sqe *sqes = (io_uring_sqe *)MAP_FAILED;
+    size_t sqRingSize = 0;
+    size_t cqRingSize = 0;
+    size_t sqesSize = 0;
+    unsigned *sqHead, *sqTail, *sqMask, *sqArray;
+    unsigned *cqHead, *cqTail, *cqMask;
+    io_uring_cqe *cqes;
+    unsigned sqEntries = 0;
+    unsigned localTail = 0; // tail including queued, not yet submitted entries
+    unsigned queued = 0;    // entries queued since last submission
+
+public:
+    IoRing()
+    {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        fd = syscall(__NR_io_uring_setup, RING_ENTRIES, &params);
+        if (fd < 0)
+            return;
+        sqEntries = params.sq_entries;
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMap)
+            sqRingSize = cqRingSize = sqRingSize > cqRingSize ? sqRingSize : cqRingSize;
+        sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        cqRing = singleMap ? sqRing : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = (io_uring_sqe *)mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqes == MAP_FAILED)
+        {
+            release();
+            return;
+        }
+        sqHead = (unsigned *)((char *)sqRing + params.sq_off.head);
+        sqTail = (unsigned *)((char *)sqRing + params.sq_off.tail);
+        sqMask = (unsigned *)((char *)sqRing + params.sq_off.ring_mask);
+        sqArray = (unsigned *)((char *)sqRing + params.sq_off.array);
+        cqHead = (unsigned *)((char *)cqRing + params.cq_off.head);
+        cqTail = (unsigned *)((char *)cqRing + params.cq_off.tail);
+        cqMask = (unsigned *)((char *)cqRing + params.cq_off.ring_mask);
+        cqes = (io_uring_cqe *)((char *)cqRing + params.cq_off.cqes);
+        localTail = *sqTail;
+        if (!supports({IORING_OP_READ, IORING_OP_WRITE, IORING_OP_FSYNC}))
+            release();
+    }
+    IoRing(IoRing const &) = delete;
+    IoRing &operator=(IoRing const &) = delete;
+    ~IoRing() { release(); }
+
+    /**
+     * @brief Unmaps the rings and closes the ring; the ring is not ready afterwards
+     */
+    void release()
+    {
+        if (sqes != MAP_FAILED)
+            munmap(sqes, sqesSize);
+        if (cqRing != MAP_FAILED && cqRing != sqRing)
+            munmap(cqRing, cqRingSize);
+        if (sqRing != MAP_FAILED)
+            munmap(sqRing, sqRingSize);
+        sqes = (io_uring_sqe *)MAP_FAILED;
+        sqRing = cqRing = MAP_FAILED;
+        if (fd >= 0)
+            close(fd);
+        fd = -1;
+    }
+
+    /**
+     * @brief Returns true when the kernel supports all <opcodes> (IORING_REGISTER_PROBE). Kernels
+     * without probing predate the read and write opcodes, so they support none.
+     */
+    bool supports(std::initializer_list<uint8_t> opcodes) const
+    {
+        std::vector<char> buffer(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+        io_uring_probe *probe = (io_uring_probe *)buffer.data();
+        if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) < 0)
+            return false;
+        for (uint8_t opcode : opcodes)
+        {
+            if (opcode >= probe->ops_len || !(probe->ops[opcode].flags & IO_URING_OP_SUPPORTED))
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Returns true when requests can be submitted
+     */
+    bool ready() const { return fd >= 0; }
+    /**
+     * @brief Returns number of requests that can be in flight at once
+     */
+    unsigned capacity() const { return sqEntries; }
+
+    /**
+     * @brief Returns number of entries that can be queued before the submission ring is full
+     */
+    unsigned freeEntries() const
+    {
+        return sqEntries - (localTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE));
+    }
+
+    /**
+     * @brief Drops all entries queued since the last submission, so a later submission does not
+     * send them
+     */
+    void discardQueued()
+    {
+        localTail -= queued;
+        queued = 0;
+        __atomic_store_n(sqTail, localTail, __ATOMIC_RELEASE);
+    }
+
+    /**
+     * @brief Returns cleared submission entry queued for the next submission. Returns nullptr when
+     * the submission ring is full.
+     */
+    io_uring_sqe *queueEntry()
+    {
+        if (localTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries)
+            return nullptr;
+        unsigned index = localTail & *sqMask;
+        sqArray[index] = index;
+        memset(&sqes[index], 0, sizeof(io_uring_sqe));
+        localTail++;
+        queued++;
+        return &sqes[index];
+    }
+
+    /**
+     * @brief Submits all queued entries with one system call and waits for at least <waitCount>
+     * completions. Returns false when the submission failed.
+     */
+    bool submitAndWait(unsigned waitCount)
+    {
+        __atomic_store_n(sqTail, localTail, __ATOMIC_RELEASE);
+        while (true)
+        {
+            int submitted = syscall(__NR_io_uring_enter, fd, queued, waitCount, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (submitted >= 0)
+            {
+                queued -= submitted < (int)queued ? submitted : queued;
+                if (queued == 0)
+                    return true;
+                continue; // kernel took only part of the entries
+            }
+            if (errno != EINTR)
+                return false;
+        }
+    }
+
+    /**
+     * @brief Takes the next completion off the ring. Returns false when there is none.
+     */
+    bool popCompletion(io_uring_cqe &completion)
+    {
+        unsigned head = *cqHead;
+        if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE))
+            return false;
+        completion = cqes[head & *cqMask];
+        __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+};
+
+/**
+ * @brief Returns the ring of the calling thread, set up on first use
+ *
+ * @return IoRing&
+ */
+static IoRing &threadRing()
+{
+    thread_local IoRing ring;
+    return ring;
+}
+
+/**
+ * @brief One read request of a chunk of a file
+ */
+struct ReadChunk
+{
+    size_t file;
+    size_t offset;
+    size_t length;
+};
+
+/**
+ * @brief Reads all files with io_uring: the chunks of all files are queued in large batches, so
+ * the files are read concurrently. Files with failed or short reads are read again with POSIX.
+ *
+ * @param filenames names of files
+ * @param files receives content of files
+ * @return bool false when io_uring failed altogether
+ */
+static bool uringReadFiles(std::vector<std::string> const &filenames, std::vector<FileContent> &files)
+{
+    IoRing &ring = threadRing();
+    std::vector<int> fds(filenames.size(), -1);
+    std::vector<bool> retry(filenames.size(), false);
+    std::vector<ReadChunk> chunks;
+    for (size_t file = 0; file < filenames.size(); file++)
+    {
+        size_t size = 0;
+        fds[file] = openForRead(filenames[file], size);
+        if (fds[file] < 0)
+            continue;
+        files[file].found = true;
+        files[file].content.resize(size);
+        for (size_t offset = 0; offset < size; offset += IO_CHUNK_SIZE)
+            chunks.push_back({file, offset, size - offset < IO_CHUNK_SIZE ? size - offset : IO_CHUNK_SIZE});
+    }
+
+    bool ringFailed = false;
+    size_t next = 0;
+    size_t inFlight = 0;
+    while (!ringFailed && (next < chunks.size() || inFlight > 0))
+    {
+        // queue as many chunks as the ring holds
+        io_uring_sqe *entry;
+        while (next < chunks.size() && inFlight < ring.capacity() && (entry = ring.queueEntry()))
+        {
+            ReadChunk const &chunk = chunks[next];
+            entry->opcode = IORING_OP_READ;
+            entry->fd = fds[chunk.file];
+            entry->addr = (uint64_t)(uintptr_t)&files[chunk.file].content[chunk.offset];
+            entry->len = chunk.length;
+            entry->off = chunk.offset;
+            entry->user_data = next;
+            next++;
+            inFlight++;
+        }
+        if (!ring.submitAndWait(1))
+        {
+            ringFailed = true;
+            break;
+        }
+        io_uring_cqe completion;
+        while (ring.popCompletion(completion))
+        {
+            inFlight--;
+            ReadChunk const &chunk = chunks[completion.user_data];
+            if (completion.res < 0 || (size_t)completion.res != chunk.length)
+                retry[chunk.file] = true;
+        }
+    }
+    // wait for requests still in flight before their buffers go away; when that fails as well,
+    // releasing the ring cancels them and drops entries that were never submitted
+    while (ringFailed && inFlight > 0 && ring.submitAndWait(1))
+    {
+        io_uring_cqe completion;
+        while (ring.popCompletion(completion))
+            inFlight--;
+    }
+    if (ringFailed)
+        ring.release(); // POSIX from now on
+
+    for (size_t file = 0; file < filenames.size(); file++)
+    {
+        if (fds[file] < 0)
+            continue;
+        close(fds[file]);
+        if (retry[file] || ringFailed)
+            files[file] = posixRead(filenames[file]);
+    }
+    return !ringFailed;
+}
+
+/**
+ * @brief Writes <content> to file <filename> with io_uring: all writes and a final fsync are
+ * submitted as one linked chain with one system call. Any failure of the ring, including failed or
+ * short completions, sets <ringFailed>, so the caller writes the file again with POSIX. The chain is
+ * only queued when the ring has room for all of it; after a failed wait the ring is released, so no
+ * request of it can still write to the file.
+ *
+ * @param filename name of file
+ * @param content new content
+ * @param ringFailed set to true when the content could not be written with io_uring
+ * @return bool true when the content is on disk
+ */
+static bool uringWriteFile(std::string const &filename, std::string const &content, bool &ringFailed)
+{
+    IoRing &ring = threadRing();
+    size_t chunkCount = (content.size() + IO_CHUNK_SIZE - 1) / IO_CHUNK_SIZE;
+    if (chunkCount + 1 > ring.freeEntries())
+    {
+        ringFailed = true; // chain does not fit into the free part of the ring
+        return false;
+    }
+    int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, FILE_MODE);
+    if (fd < 0)
+        return false;
+
+    for (size_t chunk = 0; chunk <= chunkCount; chunk++)
+    {
+        io_uring_sqe *entry = ring.queueEntry();
+        if (entry == nullptr)
+        {
+            ringFailed = true;
+            ring.discardQueued(); // no part of the chain may be sent later
+            close(fd);
+            return false;
+        }
+        entry->fd = fd;
+        entry->user_data = chunk;
+        if (chunk == chunkCount)
+        {
+            entry->opcode = IORING_OP_FSYNC;
+            break;
+        }
+        size_t offset = chunk * IO_CHUNK_SIZE;
+        entry->opcode = IORING_OP_WRITE;
+        entry->flags = IOSQE_IO_LINK; // following requests only run when this one succeeded
+        entry->addr = (uint64_t)(uintptr_t)(content.data() + offset);
+        entry->len = content.size() - offset < IO_CHUNK_SIZE ? content.size() - offset : IO_CHUNK_SIZE;
+        entry->off = offset;
+    }
+
+    unsigned pending = chunkCount + 1;
+    bool waited = ring.submitAndWait(pending);
+    while (waited && pending > 0)
+    {
+        io_uring_cqe completion;
+        if (!ring.popCompletion(completion))
+        {
+            waited = ring.submitAndWait(pending);
+            continue;
+        }
+        pending--;
+        size_t expected = completion.user_data == chunkCount
+                              ? 0
+                              : std::min<size_t>(content.size() - completion.user_data * IO_CHUNK_SIZE, IO_CHUNK_SIZE);
+        if (completion.res < 0 || (size_t)completion.res != expected)
+            ringFailed = true; // failed, short, or canceled after a failed link
+    }
+    if (!waited)
+    {
+        ringFailed = true;
+        ring.release(); // cancels requests still in flight; POSIX from now on
+    }
+    return close(fd) == 0 && !ringFailed;
+}
+#endif
+
+/**
+ * @brief Reads whole file <filename>. Sets found to false when the file cannot be opened.
+ *
+ * @param filename name of file
+ * @return FileContent
+ */
+FileContent readFile(std::string const &filename)
+{
+    return readFiles({filename}).front();
+}
+
+/**
+ * @brief Reads several whole files at once (concurrently with io_uring). Sets found to false for
+ * files which cannot be opened.
+ *
+ * @param filenames names of files
+ * @return std::vector<FileContent>
+ */
+std::vector<FileContent> readFiles(std::vector<std::string> const &filenames)
+{
+    std::vector<FileContent> files(filenames.size());
+#ifdef DECISION_IO_URING
+    if (threadRing().ready() && uringReadFiles(filenames, files))
+        return files;
+#endif
+    for (size_t file = 0; file < filenames.size(); file++)
+        files[file] = posixRead(filenames[file]);
+    return files;
+}
+
+/**
+ * @brief Replaces content of file <filename> and flushes it to disk. The content is written to a
+ * temporary file which replaces <filename> by rename, so readers and a failed write never see a
+ * truncated file. Returns false when the file could not be written (<filename> is unchanged then).
+ *
+ * @param filename name of file
+ * @param content new content
+ * @return bool
+ */
+bool writeFile(std::string const &filename, std::string const &content)
+{
+    std::string tempFilename = filename + TEMP_SUFFIX;
+    bool written = false;
+#ifdef DECISION_IO_URING
+    bool ringFailed = !threadRing().ready();
+    if (!ringFailed)
+        written = uringWriteFile(tempFilename, content, ringFailed);
+    if (ringFailed)
+#endif
+        written = posixWrite(tempFilename, content);
+    if (written && rename(tempFilename.c_str(), filename.c_str()) == 0)
+        return true;
+    int error = errno;
+    unlink(tempFilename.c_str());
+    errno = error; // reported by callers
+    return false;
+}
+
+/**
+ * @brief Returns name of the I/O backend used by the calling thread ("io_uring" or "posix")
+ *
+ * @return const char*
+ */
+const char *ioBackendName()
+{
+#ifdef DECISION_IO_URING
+    if (threadRing().ready())
+        return "io_uring";
+#endif
+    return "posix";
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <string>
+#include <vector>
+
+/**
+ * @brief Content of a file read by readFiles
+ */
+struct FileContent
+{
+    bool found = false;  // file could be opened
+    std::string content; // whole content of the file
+};
+
+FileContent readFile(std::string const &filename);
+std::vector<FileContent> readFiles(std::vector<std::string> const &filenames);
+bool writeFile(std::string const &filename, std::string const &content);
+const char *ioBackendName();
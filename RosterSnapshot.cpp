@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <thread>
+#include "RosterSnapshot.hpp"
+
+/**
+ * @brief Unpins the epoch of the reader, so snapshots replaced meanwhile can be freed
+ */
+SnapshotReader::~SnapshotReader()
+{
+    if (slot)
+        slot->pinned.store(0, std::memory_order_release);
+}
+
+/**
+ * @brief Publishes <first> as current snapshot
+ *
+ * @param first first snapshot, e.g. of takeSnapshot
+ */
+RosterSnapshots::RosterSnapshots(RosterSnapshot first) : current(new RosterSnapshot(std::move(first)))
+{
+}
+
+/**
+ * @brief Frees current and replaced snapshots. Requires that no reader exists anymore.
+ */
+RosterSnapshots::~RosterSnapshots()
+{
+    delete current.load();
+    for (auto const &[replacedIn, snapshot] : retired)
+        delete snapshot;
+}
+
+/**
+ * @brief Returns the current snapshot without taking a lock. The epoch is pinned before the
+ * snapshot is loaded, so a writer replacing the snapshot meanwhile sees the pin before freeing it.
+ * Waits only when all SNAPSHOT_READER_SLOTS slots are taken.
+ *
+ * @return SnapshotReader
+ */
+SnapshotReader RosterSnapshots::read()
+{
+    thread_local size_t hint = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    while (true)
+    {
+        for (size_t i = 0; i < SNAPSHOT_READER_SLOTS; i++)
+        {
+            EpochSlot &slot = slots[(hint + i) % SNAPSHOT_READER_SLOTS];
+            uint64_t free = 0;
+            if (slot.pinned.load(std::memory_order_relaxed) == 0 &&
+                slot.pinned.compare_exchange_strong(free, epoch.load()))
+            {
+                hint += i;
+                return SnapshotReader(&slot, current.load());
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+/**
+ * @brief Replaces the current snapshot by <snapshot> and frees replaced snapshots no reader can
+ * hold anymore. Readers of the replaced snapshot keep it until they are destroyed.
+ *
+ * @param snapshot new snapshot
+ */
+void RosterSnapshots::publish(std::unique_ptr<RosterSnapshot const> snapshot)
+{
+    std::lock_guard<std::mutex> lock(writer);
+    RosterSnapshot const *replaced = current.exchange(snapshot.release());
+    retired.push_back({epoch.fetch_add(1), replaced});
+    reclaim();
+}
+
+/**
+ * @brief Frees replaced snapshots: a snapshot replaced in epoch E can only be held by readers pinned
+ * to an epoch <= E. Requires lock of writer.
+ */
+void RosterSnapshots::reclaim()
+{
+    uint64_t oldestPinned = UINT64_MAX;
+    for (EpochSlot const &slot : slots)
+    {
+        uint64_t pinned = slot.pinned.load();
+        if (pinned != 0)
+            oldestPinned = std::min(oldestPinned, pinned);
+    }
+    auto freed = std::remove_if(retired.begin(), retired.end(), [oldestPinned](auto const &entry)
+                                {
+        if (entry.first >= oldestPinned)
+            return false;
+        delete entry.second;
+        return true; });
+    retired.erase(freed, retired.end());
+}
+
+/**
+ * @brief Returns number of replaced snapshots not freed yet (after freeing all that can be)
+ *
+ * @return size_t
+ */
+size_t RosterSnapshots::retiredCount()
+{
+    std::lock_guard<std::mutex> lock(writer);
+    reclaim();
+    return retired.size();
+}
+
+/**
+ * @brief Returns the points of <roster> as snapshot
+ *
+ * @param roster roster
+ * @return RosterSnapshot
+ */
+RosterSnapshot takeSnapshot(CSVManager &roster)
+{
+    return {roster.getVersion(), roster.getPointsColumn()};
+}
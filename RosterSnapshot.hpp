@@ -0,0 +1,81 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "CSVManager.hpp"
+
+#define SNAPSHOT_READER_SLOTS 128 // readers holding a snapshot at the same time
+#define SNAPSHOT_SLOT_SIZE 64     // one cache line per slot, so pinning readers do not share lines
+
+/**
+ * @brief Immutable points of a roster. Names, seminar groups and indexes are not part of it; they
+ * stay with the roster the snapshot was taken of.
+ */
+struct RosterSnapshot
+{
+    uint64_t version = 0;        // roster version of the points
+    std::vector<uint8_t> points; // points per roster position
+};
+
+/**
+ * @brief Epoch a reader is pinned to (0 = slot free)
+ */
+struct alignas(SNAPSHOT_SLOT_SIZE) EpochSlot
+{
+    std::atomic<uint64_t> pinned{0};
+};
+
+class RosterSnapshots;
+
+/**
+ * @brief Snapshot held by one reader. The snapshot stays valid until the reader is destroyed,
+ * however many snapshots are published meanwhile.
+ */
+class SnapshotReader
+{
+private:
+    EpochSlot *slot;
+    RosterSnapshot const *snapshot;
+
+public:
+    SnapshotReader(EpochSlot *slot, RosterSnapshot const *snapshot) : slot(slot), snapshot(snapshot) {}
+    SnapshotReader(SnapshotReader &&other) noexcept : slot(other.slot), snapshot(other.snapshot) { other.slot = nullptr; }
+    SnapshotReader(SnapshotReader const &) = delete;
+    SnapshotReader &operator=(SnapshotReader const &) = delete;
+    SnapshotReader &operator=(SnapshotReader &&) = delete;
+    ~SnapshotReader();
+    RosterSnapshot const &operator*() const { return *snapshot; }
+    RosterSnapshot const *operator->() const { return snapshot; }
+};
+
+/**
+ * @brief Points of a roster for many concurrent readers and occasional writers (RCU). Readers take
+ * no lock: they pin the current epoch in a free slot and load the current snapshot. Writers build a
+ * new snapshot copy-on-write and publish it by swapping the pointer; replaced snapshots are freed
+ * once no reader is pinned to an epoch in which they could have been loaded.
+ */
+class RosterSnapshots
+{
+private:
+    std::atomic<RosterSnapshot const *> current;
+    std::atomic<uint64_t> epoch{1};
+    std::array<EpochSlot, SNAPSHOT_READER_SLOTS> slots;
+    std::mutex writer;                                                 // serializes publishing and freeing
+    std::vector<std::pair<uint64_t, RosterSnapshot const *>> retired; // replaced snapshots with epoch of replacement
+
+    void reclaim();
+
+public:
+    RosterSnapshots(RosterSnapshot first);
+    RosterSnapshots(RosterSnapshots const &) = delete;
+    RosterSnapshots &operator=(RosterSnapshots const &) = delete;
+    ~RosterSnapshots();
+    SnapshotReader read();
+    void publish(std::unique_ptr<RosterSnapshot const> snapshot);
+    size_t retiredCount();
+};
+
+RosterSnapshot takeSnapshot(CSVManager &roster);
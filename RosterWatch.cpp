@@ -0,0 +1,96 @@
+#include <cstring>
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "RosterWatch.hpp"
+
+#define INOTIFY_BUFFER_SIZE 4096
+
+/**
+ * @brief Starts watching the CSV-file of <roster>. The roster has to outlive the watch.
+ *
+ * @param roster roster to keep up to date
+ */
+RosterWatch::RosterWatch(CSVManager &roster) : roster(roster)
+{
+    std::string const &filename = roster.getFilename();
+    size_t slash = filename.rfind('/');
+    directory = slash == std::string::npos ? "." : filename.substr(0, slash + 1);
+    basename = slash == std::string::npos ? filename : filename.substr(slash + 1);
+
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd >= 0 &&
+        inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        close(inotifyFd);
+        inotifyFd = -1;
+    }
+    statChanged(); // remember current modification time and size
+}
+
+RosterWatch::~RosterWatch()
+{
+    if (inotifyFd >= 0)
+        close(inotifyFd);
+}
+
+/**
+ * @brief Compares modification time and size of the file with the last seen ones and remembers
+ * the current ones. Returns true when they differ.
+ *
+ * @return bool
+ */
+bool RosterWatch::statChanged()
+{
+    struct stat fileStat;
+    if (stat(roster.getFilename().c_str(), &fileStat) != 0)
+    {
+        fileStat.st_size = -1; // missing file
+        fileStat.st_mtim = {};
+    }
+    bool differs = fileStat.st_size != size || fileStat.st_mtim.tv_sec != mtime.tv_sec ||
+                   fileStat.st_mtim.tv_nsec != mtime.tv_nsec;
+    size = fileStat.st_size;
+    mtime = fileStat.st_mtim;
+    return differs;
+}
+
+/**
+ * @brief Returns true when the file was changed since the last refresh. Does not block.
+ *
+ * @return bool
+ */
+bool RosterWatch::changed()
+{
+    if (inotifyFd < 0)
+        return pending = pending || statChanged();
+
+    alignas(inotify_event) char buffer[INOTIFY_BUFFER_SIZE];
+    ssize_t length;
+    while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0)
+    {
+        for (char *ptr = buffer; ptr < buffer + length; ptr += sizeof(inotify_event) + ((inotify_event *)ptr)->len)
+        {
+            inotify_event const *event = (inotify_event const *)ptr;
+            if (event->len > 0 && basename == event->name)
+                pending = true;
+        }
+    }
+    return pending;
+}
+
+/**
+ * @brief Applies changes of the file to the roster when there are any (see CSVManager::reloadChanges).
+ * A missing or malformed file leaves the roster unchanged.
+ *
+ * @return RosterDiff
+ */
+RosterDiff RosterWatch::refresh()
+{
+    if (!changed())
+        return RosterDiff();
+    pending = false;
+    statChanged();
+    return roster.reloadChanges();
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <ctime>
+#include <sys/types.h>
+#include "CSVManager.hpp"
+
+/**
+ * @brief Watches the CSV-file of a roster for external changes and applies them to the roster.
+ * Uses inotify on the directory of the file for completed writes and files renamed into place (so
+ * half-written files are not read) and falls back to comparing modification time and size when
+ * inotify is not available.
+ */
+class RosterWatch
+{
+private:
+    CSVManager &roster;
+    std::string directory;
+    std::string basename;
+    int inotifyFd = -1;
+    struct timespec mtime = {};
+    off_t size = -1;
+    bool pending = false; // change seen but not applied yet
+
+    bool statChanged();
+
+public:
+    RosterWatch(CSVManager &roster);
+    RosterWatch(RosterWatch const &) = delete;
+    RosterWatch &operator=(RosterWatch const &) = delete;
+    ~RosterWatch();
+    bool changed();
+    RosterDiff refresh();
+    /**
+     * @brief Returns true when changes are detected by inotify, false when by polling
+     */
+    bool usesInotify() const { return inotifyFd >= 0; }
+    /**
+     * @brief Returns descriptor becoming readable on changes (for poll/select), -1 when polling
+     */
+    int getFd() const { return inotifyFd; }
+};
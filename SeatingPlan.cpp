@@ -0,0 +1,114 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "SeatingPlan.hpp"
+#include "RosterIO.hpp"
+
+/**
+ * @brief Maps seating plan <filename>; an empty filename leaves the plan closed
+ *
+ * @param filename file of the plan
+ */
+SeatingPlan::SeatingPlan(std::string const &filename)
+{
+    if (!filename.empty())
+        open(filename);
+}
+
+SeatingPlan::~SeatingPlan()
+{
+    close();
+}
+
+/**
+ * @brief Maps seating plan <filename> read-only. Returns false and leaves the plan closed when the
+ * file cannot be mapped or is no seating plan of this machine.
+ *
+ * @param filename file of the plan
+ * @return bool
+ */
+bool SeatingPlan::open(std::string const &filename)
+{
+    close();
+    int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat fileStat;
+    if (fd < 0 || fstat(fd, &fileStat) != 0)
+    {
+        std::cerr << "Error:\t" << "Could not open seating plan \"" << filename << "\": " << strerror(errno) << std::endl;
+        if (fd >= 0)
+            ::close(fd);
+        return false;
+    }
+    size_t fileSize = fileStat.st_size;
+    void *file = fileSize >= sizeof(PlanHeader) ? mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    PlanHeader const *fileHeader = (PlanHeader const *)file;
+    if (file == MAP_FAILED || memcmp(fileHeader->magic, PLAN_MAGIC, sizeof(fileHeader->magic)) != 0 ||
+        fileHeader->version != PLAN_VERSION || fileHeader->byteOrder != PLAN_BYTE_ORDER ||
+        fileSize != sizeof(PlanHeader) + (size_t)fileHeader->count * sizeof(PlanEntry))
+    {
+        std::cerr << "Error:\t" << "\"" << filename << "\" is no seating plan of this version." << std::endl;
+        if (file != MAP_FAILED)
+            munmap(file, fileSize);
+        return false;
+    }
+    mapped = file;
+    mappedSize = fileSize;
+    header = fileHeader;
+    return true;
+}
+
+/**
+ * @brief Unmaps the plan
+ */
+void SeatingPlan::close()
+{
+    if (mapped)
+        munmap(mapped, mappedSize);
+    mapped = nullptr;
+    mappedSize = 0;
+    header = nullptr;
+}
+
+/**
+ * @brief Writes seating plan <filename> with <entries> for the roster with layout hash <layoutHash>.
+ * Returns true when the file was written.
+ *
+ * @param filename file of the plan
+ * @param layoutHash layout hash of the roster
+ * @param rowCount number of seating rows of the selection
+ * @param entries students with seating row, ordered by name
+ * @return bool
+ */
+bool SeatingPlan::save(std::string const &filename, uint64_t layoutHash, uint32_t rowCount, std::vector<PlanEntry> const &entries)
+{
+    PlanHeader planHeader = {{PLAN_MAGIC[0], PLAN_MAGIC[1], PLAN_MAGIC[2]}, PLAN_VERSION, PLAN_BYTE_ORDER, layoutHash, rowCount, (uint32_t)entries.size()};
+    std::string content((char const *)&planHeader, sizeof(planHeader));
+    content.append((char const *)entries.data(), entries.size() * sizeof(PlanEntry));
+    // replaced by rename (see writeFile), so processes deciding on the old plan keep a complete mapping
+    if (writeFile(filename, content))
+        return true;
+    std::cerr << "Error:\t" << "Could not write seating plan \"" << filename << "\": " << strerror(errno) << std::endl;
+    return false;
+}
+
+/**
+ * @brief Returns file of seating plan <planName> of the roster in <csvFile>: the CSV file name
+ * with ".csv" replaced by ".<planName>.plan"
+ *
+ * @param csvFile CSV file of the roster
+ * @param planName name of the plan
+ * @return std::string
+ */
+std::string planFilename(std::string const &csvFile, std::string const &planName)
+{
+    std::string base = csvFile;
+    if (base.size() > 4 && base.compare(base.size() - 4, 4, ".csv") == 0)
+        base.erase(base.size() - 4);
+    return base + "." + planName + ".plan";
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define PLAN_MAGIC "DHP"
+#define PLAN_VERSION 1
+#define PLAN_BYTE_ORDER 0x01020304u
+
+/**
+ * @brief Header of a seating plan file. The file is mapped as is, so integers are in the byte
+ * order of the machine that saved it (marked by byteOrder).
+ *
+ * Layout: header | count * PlanEntry (ordered by name of the student, no student twice)
+ */
+struct PlanHeader
+{
+    char magic[3];
+    uint8_t version;
+    uint32_t byteOrder;  // PLAN_BYTE_ORDER as written by the saving machine
+    uint64_t layoutHash; // CSVManager::getLayoutHash of the roster the plan was saved for
+    uint32_t rowCount;   // number of seating rows of the selection the plan was saved from
+    uint32_t count;      // number of entries
+};
+
+/**
+ * @brief Student of a seating plan with its seating row
+ */
+struct PlanEntry
+{
+    uint32_t stud; // position in roster
+    int32_t row;
+};
+
+/**
+ * @brief Saved selection of students with names resolved to roster positions. The file is mapped
+ * read-only while the object is open.
+ */
+class SeatingPlan
+{
+private:
+    void *mapped = nullptr;
+    size_t mappedSize = 0;
+    PlanHeader const *header = nullptr;
+
+public:
+    SeatingPlan() = default;
+    explicit SeatingPlan(std::string const &filename);
+    SeatingPlan(SeatingPlan const &) = delete;
+    SeatingPlan &operator=(SeatingPlan const &) = delete;
+    ~SeatingPlan();
+    bool open(std::string const &filename);
+    void close();
+    static bool save(std::string const &filename, uint64_t layoutHash, uint32_t rowCount, std::vector<PlanEntry> const &entries);
+    /**
+     * @brief Returns true when a valid plan is mapped
+     */
+    bool isOpen() const { return header != nullptr; }
+    /**
+     * @brief Returns layout hash of the roster the plan was saved for. Requires open plan.
+     */
+    uint64_t getLayoutHash() const { return header->layoutHash; }
+    /**
+     * @brief Returns number of seating rows of the plan. Requires open plan.
+     */
+    uint32_t getRowCount() const { return header->rowCount; }
+    /**
+     * @brief Returns number of students of the plan (0 when not open)
+     */
+    size_t size() const { return header ? header->count : 0; }
+    PlanEntry const *begin() const { return (PlanEntry const *)(header + 1); }
+    PlanEntry const *end() const { return begin() + size(); }
+};
+
+std::string planFilename(std::string const &csvFile, std::string const &planName);
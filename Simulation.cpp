@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <thread>
+#include "Simulation.hpp"
+#include "DescisionPipeline.hpp"
+
+#define PADDING 15
+
+/**
+ * @brief Statistics of the points of one simulated semester
+ */
+struct RunStatistics
+{
+    double stddev = 0;
+    double gini = 0;
+    double jain = 0;
+};
+
+/**
+ * @brief Returns copy of <input> for the pipelines of the simulation: no diagnostics and only
+ * students and groups existing in <roster>, so no warnings are printed per simulated semester.
+ *
+ * @param input InputStruct of the request
+ * @param roster roster of the simulation
+ * @return InputStruct
+ */
+static InputStruct quietInput(InputStruct const *input, CSVManager const &roster)
+{
+    InputStruct quiet = *input;
+    quiet.verbose = false;
+    quiet.eventLogFile = "";
+    quiet.threads = 1; // semesters already run in parallel
+    if (quiet.semGroup == "")
+        quiet.allowRepeater = true; // repeaters cannot be sorted out anyway
+    for (auto &studRow : quiet.studSelection)
+    {
+        for (auto it = studRow.second.begin(); it != studRow.second.end();)
+            it = roster.getStudentIndex(*it) == NO_STUDENT ? studRow.second.erase(it) : std::next(it);
+    }
+    for (auto &groupRow : quiet.groupSelection)
+    {
+        for (auto it = groupRow.second.begin(); it != groupRow.second.end();)
+            it = roster.getGroupMembers(*it).empty() ? groupRow.second.erase(it) : std::next(it);
+    }
+    for (auto it = quiet.excludedStuds.begin(); it != quiet.excludedStuds.end();)
+        it = roster.getStudentIndex(*it) == NO_STUDENT ? quiet.excludedStuds.erase(it) : std::next(it);
+    return quiet;
+}
+
+/**
+ * @brief Returns seed of simulated semester <run>, so every semester has its own random stream
+ * independent of the thread it runs on.
+ *
+ * @param seed seed of the simulation
+ * @param run number of the simulated semester
+ * @return uint32_t
+ */
+static uint32_t runSeed(uint32_t seed, size_t run)
+{
+    std::seed_seq seq{seed, (uint32_t)run, (uint32_t)(run >> 32)};
+    uint32_t runSeed;
+    seq.generate(&runSeed, &runSeed + 1);
+    return runSeed;
+}
+
+/**
+ * @brief Simulates semesters of decisions on <roster>. In every session of a semester
+ * input->pickCount students of the present selection are chosen and get a point. Semesters are
+ * spread over threads, which share the roster; every semester keeps its points in its pipeline.
+ * The result does not depend on the number of threads.
+ *
+ * @param input InputStruct holding the request and the simulation parameters
+ * @param roster roster to start every semester with (never written)
+ * @return SimulationResult
+ */
+SimulationResult simulateSemesters(InputStruct const *input, CSVManager const &roster)
+{
+    InputStruct quiet = quietInput(input, roster);
+    SimulationResult result;
+    result.runs = input->simRuns;
+    result.sessions = input->simSessions;
+    result.threads = input->threads ? input->threads : std::max(1u, std::thread::hardware_concurrency());
+    result.seed = input->simSeed >= 0 ? (uint32_t)input->simSeed : std::random_device{}();
+    result.students = DescisionPipeline(&quiet, roster).getSelectedStudents();
+
+    // position in result per roster position
+    size_t studCount = result.students.size();
+    std::vector<uint32_t> slotOf(roster.getStudentCount(), NO_STUDENT);
+    for (uint32_t slot = 0; slot < studCount; slot++)
+        slotOf[result.students[slot]] = slot;
+
+    std::vector<RunStatistics> runStats(result.runs);
+    std::vector<std::vector<uint64_t>> threadPicks(result.threads, std::vector<uint64_t>(studCount));
+    std::vector<std::vector<uint64_t>> threadPoints(result.threads, std::vector<uint64_t>(studCount));
+    auto simulate = [&](unsigned thread)
+    {
+        std::vector<double> points(studCount);
+        for (size_t run = thread; run < result.runs; run += result.threads)
+        {
+            DescisionPipeline pipe(&quiet, roster);
+            pipe.seedRandom(runSeed(result.seed, run));
+            for (size_t session = 0; session < result.sessions; session++)
+            {
+                for (uint32_t chosen : pipe.decideForStudents(input->pickCount, input->attendance))
+                    threadPicks[thread][slotOf[chosen]]++;
+            }
+            for (size_t slot = 0; slot < studCount; slot++)
+            {
+                points[slot] = pipe.getPoints(result.students[slot]);
+                threadPoints[thread][slot] += points[slot];
+            }
+            runStats[run] = {standardDeviation(points), giniCoefficient(points), jainIndex(points)};
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned thread = 1; thread < result.threads; thread++)
+        workers.emplace_back(simulate, thread);
+    simulate(0);
+    for (std::thread &worker : workers)
+        worker.join();
+
+    // merge in fixed order
+    result.picks.assign(studCount, 0);
+    result.points.assign(studCount, 0);
+    for (unsigned thread = 0; thread < result.threads; thread++)
+    {
+        for (size_t slot = 0; slot < studCount; slot++)
+        {
+            result.picks[slot] += threadPicks[thread][slot];
+            result.points[slot] += threadPoints[thread][slot];
+        }
+    }
+    if (result.runs == 0)
+        return result;
+    for (size_t slot = 0; slot < studCount; slot++)
+    {
+        result.picks[slot] /= result.runs;
+        result.points[slot] /= result.runs;
+    }
+    for (RunStatistics const &stats : runStats)
+    {
+        result.pointsStddev += stats.stddev / result.runs;
+        result.pointsGini += stats.gini / result.runs;
+        result.pointsJain += stats.jain / result.runs;
+    }
+    result.picksGini = giniCoefficient(result.picks);
+    result.picksJain = jainIndex(result.picks);
+    return result;
+}
+
+/**
+ * @brief Prints parameters, fairness statistics and picks and points per student of a simulation
+ *
+ * @param result result of the simulation
+ * @param roster roster of the simulation
+ * @param out stream to print to
+ */
+void printSimulationResult(SimulationResult const &result, CSVManager const &roster, std::ostream &out)
+{
+    out << "Simulated " << result.runs << " semesters of " << result.sessions << " sessions on "
+        << result.threads << " threads (seed " << result.seed << ")\n"
+        << std::fixed << std::setprecision(3)
+        << "points after semester:\tstandard deviation " << result.pointsStddev << "\tGini " << result.pointsGini
+        << "\tJain's index " << result.pointsJain << "\n"
+        << "picks per semester:\tGini " << result.picksGini << "\tJain's index " << result.picksJain << "\n\n"
+        << padTo("name", PADDING) << "| " << padTo("picks", PADDING) << "| points\n"
+        << padTo("", PADDING, '-') << "+-" << padTo("", PADDING, '-') << "+-" << padTo("", PADDING, '-') << "\n";
+    for (size_t slot = 0; slot < result.students.size(); slot++)
+    {
+        std::ostringstream picks;
+        picks << std::fixed << std::setprecision(2) << result.picks[slot];
+        out << padTo(std::string(roster.getName(result.students[slot])), PADDING) << "| "
+            << padTo(picks.str(), PADDING) << "| " << std::setprecision(2) << result.points[slot] << "\n";
+    }
+    out << std::defaultfloat << std::flush;
+}
+
+/**
+ * @brief Returns the population standard deviation of <values>
+ *
+ * @param values values
+ * @return double
+ */
+double standardDeviation(std::vector<double> const &values)
+{
+    if (values.empty())
+        return 0;
+    double mean = 0;
+    for (double value : values)
+        mean += value / values.size();
+    double variance = 0;
+    for (double value : values)
+        variance += (value - mean) * (value - mean) / values.size();
+    return std::sqrt(variance);
+}
+
+/**
+ * @brief Returns the Gini coefficient of <values> (0 = all equal, towards 1 = concentrated on
+ * few). Returns 0 when all values are 0.
+ *
+ * @param values non-negative values
+ * @return double
+ */
+double giniCoefficient(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    double sum = 0;
+    double weightedSum = 0;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        sum += values[i];
+        weightedSum += (i + 1) * values[i];
+    }
+    if (sum == 0)
+        return 0;
+    double n = values.size();
+    return 2 * weightedSum / (n * sum) - (n + 1) / n;
+}
+
+/**
+ * @brief Returns Jain's fairness index of <values> (1 = all equal, 1/n = concentrated on one).
+ * Returns 1 when all values are 0.
+ *
+ * @param values non-negative values
+ * @return double
+ */
+double jainIndex(std::vector<double> const &values)
+{
+    double sum = 0;
+    double squareSum = 0;
+    for (double value : values)
+    {
+        sum += value;
+        squareSum += value * value;
+    }
+    if (squareSum == 0)
+        return 1;
+    return sum * sum / (values.size() * squareSum);
+}
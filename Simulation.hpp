@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "InputStruct.hpp"
+#include "CSVManager.hpp"
+
+/**
+ * @brief Outcome of simulated semesters on a selection. Per-student values are averaged over all
+ * runs; fairness statistics of the points are computed per run and averaged.
+ */
+struct SimulationResult
+{
+    size_t runs = 0;
+    size_t sessions = 0;
+    unsigned threads = 0;
+    uint32_t seed = 0;
+    std::vector<uint32_t> students; // roster positions of the selection
+    std::vector<double> picks;      // picks per semester, per student
+    std::vector<double> points;     // points after the semester, per student
+    double pointsStddev = 0;
+    double pointsGini = 0;
+    double pointsJain = 0;
+    double picksGini = 0;
+    double picksJain = 0;
+};
+
+SimulationResult simulateSemesters(InputStruct const *input, CSVManager const &roster);
+void printSimulationResult(SimulationResult const &result, CSVManager const &roster, std::ostream &out);
+double standardDeviation(std::vector<double> const &values);
+double giniCoefficient(std::vector<double> values);
+double jainIndex(std::vector<double> const &values);
@@ -0,0 +1,78 @@
+#include "WorkerPool.hpp"
+
+/**
+ * @brief Returns the pool shared by all pipelines of the process
+ *
+ * @return WorkerPool&
+ */
+WorkerPool &WorkerPool::shared()
+{
+    static WorkerPool pool;
+    return pool;
+}
+
+/**
+ * @brief Stops the threads after the parts already queued
+ *
+ */
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+/**
+ * @brief Runs queued parts until the pool stops
+ *
+ */
+void WorkerPool::work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wake.wait(lock, [this]
+                  { return stopping || !jobs.empty(); });
+        if (jobs.empty())
+            return; // stopping
+        Job job = jobs.back();
+        jobs.pop_back();
+        lock.unlock();
+        job.batch->call(job.batch->task, job.part);
+        lock.lock();
+        if (--job.batch->remaining == 0)
+            job.batch->done.notify_one();
+    }
+}
+
+/**
+ * @brief Queues parts 1 to <parts> - 1 of <task>, runs part 0 and waits for the others. Starts
+ * threads until there is one per queued part.
+ *
+ * @param parts number of parts
+ * @param call calls <task> with a part
+ * @param task function called per part
+ */
+void WorkerPool::runBatch(unsigned parts, void (*call)(void *task, unsigned part), void *task)
+{
+    Batch batch{call, task, parts - 1, {}};
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (workers.size() < parts - 1)
+            workers.emplace_back(&WorkerPool::work, this);
+        for (unsigned part = parts - 1; part >= 1; part--)
+            jobs.push_back({&batch, part});
+    }
+    if (parts > 2)
+        wake.notify_all();
+    else if (parts == 2)
+        wake.notify_one();
+    call(task, 0);
+    std::unique_lock<std::mutex> lock(mutex);
+    batch.done.wait(lock, [&batch]
+                    { return batch.remaining == 0; });
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Process-wide threads for parallel rule passes. Threads are started when a pass first needs
+ * them and are kept until the process exits, so passes do not create threads. Safe for concurrent
+ * pipelines; their parts share the threads.
+ */
+class WorkerPool
+{
+private:
+    /**
+     * @brief Parts of one call of run: task, parts still running and signal of the last one
+     */
+    struct Batch
+    {
+        void (*call)(void *task, unsigned part);
+        void *task;
+        unsigned remaining;
+        std::condition_variable done;
+    };
+
+    /**
+     * @brief Part <part> of batch <batch>, waiting for a thread
+     */
+    struct Job
+    {
+        Batch *batch;
+        unsigned part;
+    };
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<Job> jobs; // taken from the back
+    std::vector<std::thread> workers;
+    bool stopping = false;
+
+    void work();
+    void runBatch(unsigned parts, void (*call)(void *task, unsigned part), void *task);
+
+public:
+    ~WorkerPool();
+    static WorkerPool &shared();
+
+    /**
+     * @brief Calls <task>(part) for every part 0 to <parts> - 1 and returns when all calls returned.
+     * Part 0 runs on the calling thread, the others on threads of the pool.
+     *
+     * @param parts number of parts
+     * @param task function called per part
+     */
+    template <typename Task>
+    void run(unsigned parts, Task &task)
+    {
+        runBatch(parts, [](void *context, unsigned part)
+                 { (*static_cast<Task *>(context))(part); },
+                 &task);
+    }
+};
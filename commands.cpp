@@ -0,0 +1,151 @@
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include "commands.hpp"
+#include "Simulation.hpp"
+#include "OutputRecord.hpp"
+#include "SeatingPlan.hpp"
+
+/**
+ * @brief Returns true when the result of the command of <input> is written as one machine-readable
+ * record instead of text
+ *
+ * @param input InputStruct holding the input information
+ * @return bool
+ */
+bool recordsOutput(InputStruct const *input)
+{
+    return input->output != outputText && input->state != simulation && input->state != planSaving;
+}
+
+/**
+ * @brief Executes the command stored in <input> and writes its result as one record to <outputFd>.
+ * Returns 0 when the command was handled, -1 otherwise (also when committed points were not saved;
+ * the record then lists no changed points).
+ *
+ * @param input InputStruct holding the input information
+ * @param decider pipeline with loaded roster and selection
+ * @param outputFd descriptor to write the record to
+ * @return int
+ */
+static int runCommandRecord(InputStruct const *input, DescisionPipeline *decider, int outputFd)
+{
+    OutputRecord record;
+    record.command = input->state;
+    CSVManager const &roster = decider->getRoster();
+    bool saved = true;
+    switch (input->state)
+    {
+    case decision:
+        if (input->pickCount > 1 || input->commitPoints || input->attendance < 1.0)
+            record.chosen = decider->decideForStudents(input->pickCount, input->attendance);
+        else if (uint32_t chosenOne = decider->decideForStudent(); chosenOne != NO_STUDENT)
+            record.chosen.push_back(chosenOne);
+        if (input->commitPoints && !record.chosen.empty())
+        {
+            saved = decider->savePoints();
+            if (saved)
+                record.changedPoints = record.chosen;
+            else
+                std::cerr << "Error:\t" << "Points of the chosen students were not saved" << std::endl;
+        }
+        record.phases = decider->getPhaseCandidates();
+        break;
+    case ranking:
+        record.chosen = decider->rankStudents(input->rankCount);
+        break;
+    case increment:
+    case decrement:
+        record.changedPoints = decider->adjustPointsOfSelection(input->state == increment);
+        break;
+    default:
+        puts("ERROR: command unhandled");
+        return -1;
+    }
+    if (!writeRecord(outputFd, formatRecord(record, roster, input->output)))
+    {
+        std::cerr << "Error:\t" << "Could not write result: " << strerror(errno) << std::endl;
+        return -1;
+    }
+    return saved ? 0 : -1;
+}
+
+/**
+ * @brief Executes the command stored in <input> on the given pipeline. Returns 0 when the command
+ * was handled, -1 otherwise. Machine-readable results are written to <outputFd>.
+ *
+ * @param input InputStruct holding the input information
+ * @param decider pipeline with loaded roster and selection
+ * @param outputFd descriptor for machine-readable results
+ * @return int
+ */
+int runCommand(InputStruct const *input, DescisionPipeline *decider, int outputFd)
+{
+    if (recordsOutput(input))
+        return runCommandRecord(input, decider, outputFd);
+    CSVManager const &roster = decider->getRoster();
+    uint32_t chosenOne;
+    switch (input->state)
+    {
+    case decision:
+        if (input->pickCount > 1 || input->commitPoints || input->attendance < 1.0)
+        {
+            std::vector<uint32_t> chosen = decider->decideForStudents(input->pickCount, input->attendance);
+            if (chosen.size() == 1)
+                std::cout << "The chosen student is: \t" << roster.getName(chosen[0]) << std::endl;
+            else if (chosen.size() > 1)
+            {
+                puts("The chosen students are:");
+                for (size_t i = 0; i < chosen.size(); i++)
+                    std::cout << "\t" << i + 1 << ". " << roster.getName(chosen[i]) << "\n";
+            }
+            if (input->commitPoints && !chosen.empty())
+            {
+                if (!decider->savePoints())
+                {
+                    std::cerr << "Error:\t" << "Points of the chosen students were not saved" << std::endl;
+                    return -1;
+                }
+                for (uint32_t stud : chosen)
+                    std::cout << roster.getName(stud) << " has now " << std::to_string(roster.getPoints(stud)) << " points\n";
+            }
+            break;
+        }
+        chosenOne = decider->decideForStudent();
+        if (chosenOne != NO_STUDENT)
+            std::cout << "The chosen student is: \t" << roster.getName(chosenOne) << std::endl;
+        break;
+    case ranking:
+        puts("Ranking of the students:");
+        for (uint32_t stud : decider->rankStudents(input->rankCount))
+            std::cout << "\t" << roster.getName(stud) << " (" << std::to_string(roster.getPoints(stud)) << " points)\n";
+        break;
+    case simulation:
+        printSimulationResult(simulateSemesters(input, roster), roster, std::cout);
+        break;
+    case planSaving:
+    {
+        std::string planFile = planFilename(input->csvFile, input->planName);
+        size_t planSize = decider->getSelectedStudents().size();
+        if (planSize == 0)
+        {
+            std::cout << "Seating plan \"" << input->planName << "\" not saved: no valid students in the selection.\n";
+            return -1;
+        }
+        if (!decider->saveSeatingPlan(planFile))
+            return -1;
+        std::cout << "Saved seating plan \"" << input->planName << "\" with " << planSize << " students to \"" << planFile << "\".\n";
+        break;
+    }
+    case increment:
+        decider->incrementPointsOfSelection();
+        break;
+    case decrement:
+        decider->decrementPointsOfSelection();
+        break;
+    default:
+        puts("ERROR: command unhandled");
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,7 @@
+#pragma once
+#include <unistd.h>
+#include "InputStruct.hpp"
+#include "DescisionPipeline.hpp"
+
+bool recordsOutput(InputStruct const *input);
+int runCommand(InputStruct const *input, DescisionPipeline *decider, int outputFd = STDOUT_FILENO);
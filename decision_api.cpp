@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <cstring>
+#include "decision_api.h"
+#include "DescisionPipeline.hpp"
+#include "RosterSnapshot.hpp"
+
+/**
+ * @brief Roster behind a handle of the C API. Names, seminar groups and indexes never change after
+ * dh_open; the points are published as snapshots.
+ */
+struct dh_roster
+{
+    CSVManager csvMan;          // read-only after dh_open (its points are those of the first snapshot)
+    RosterSnapshots snapshots;  // current points
+    std::mutex writer;          // serializes dh_update_points
+};
+
+/**
+ * @brief Loads the roster of CSV-file <csv_file>. Returns NULL when the file cannot be read.
+ *
+ * @param csv_file name of csv-file
+ * @return dh_roster* handle to release with dh_close
+ */
+dh_roster *dh_open(const char *csv_file)
+{
+    if (csv_file == nullptr)
+        return nullptr;
+    try
+    {
+        FileContent file = readFile(csv_file);
+        if (!file.found)
+            return nullptr;
+        CSVManager csvMan(csv_file, std::move(file));
+        RosterSnapshot first = takeSnapshot(csvMan);
+        return new dh_roster{std::move(csvMan), std::move(first), {}};
+    }
+    catch (std::exception const &)
+    {
+        return nullptr; // malformed line
+    }
+}
+
+/**
+ * @brief Decides for one student of the selection of <request> and copies the name to <name_out>.
+ * Points are not changed. Decides on the shared roster with the points of the current snapshot,
+ * without copying the roster and without taking a lock.
+ *
+ * @param roster handle of dh_open
+ * @param request selection and rules
+ * @param name_out buffer for the name of the chosen student
+ * @param name_out_size size of <name_out> including string-end
+ * @return int DH_OK or error status
+ */
+int dh_decide(dh_roster *roster, const dh_request *request, char *name_out, size_t name_out_size)
+{
+    if (roster == nullptr || request == nullptr || name_out == nullptr)
+        return DH_ERROR_INVALID_ARGUMENT;
+
+    // only valid parts of the request, so the pipeline has nothing to complain about
+    InputStruct input;
+    input.csvFile = roster->csvMan.getFilename();
+    input.preferredPoints = request->preferred_points;
+    input.allowRepeater = request->allow_repeater != 0;
+    if (request->sem_group != nullptr && request->sem_group[0] != '\0')
+    {
+        if (parseCohortKey(request->sem_group) == INVALID_COHORT)
+            return DH_ERROR_INVALID_ARGUMENT;
+        input.semGroup = request->sem_group;
+    }
+    else
+        input.allowRepeater = true; // repeaters cannot be sorted out without seminar group
+    for (size_t i = 0; i < request->name_count; i++)
+    {
+        if (request->names[i] != nullptr && roster->csvMan.getStudentIndex(request->names[i]) != NO_STUDENT)
+            input.studSelection[request->rows ? request->rows[i] : 0].insert(request->names[i]);
+    }
+    for (size_t i = 0; i < request->group_count; i++)
+    {
+        if (request->groups[i] != nullptr && !roster->csvMan.getGroupMembers(request->groups[i]).empty())
+            input.groupSelection[0].insert(request->groups[i]);
+    }
+    if (input.studSelection.empty() && input.groupSelection.empty())
+        return DH_ERROR_NO_CANDIDATE;
+
+    // the shared roster is only read; the pinned snapshot outlives the pipeline. Decisions on
+    // snapshot points bypass the decision cache, so no lock is taken.
+    SnapshotReader snapshot = roster->snapshots.read();
+    DescisionPipeline pipe(&input, roster->csvMan, snapshot->points.data());
+    if (!pipe.hasEligibleStudents()) // e.g. only sorted out repeaters
+        return DH_ERROR_NO_CANDIDATE;
+    uint32_t chosen = pipe.decideForStudent();
+    if (chosen == NO_STUDENT)
+        return DH_ERROR_NO_CANDIDATE;
+    std::string_view name = roster->csvMan.getName(chosen);
+    if (name.size() + 1 > name_out_size)
+        return DH_ERROR_BUFFER_TOO_SMALL;
+    memcpy(name_out, name.data(), name.size());
+    name_out[name.size()] = '\0';
+    return DH_OK;
+}
+
+/**
+ * @brief Adds <deltas>[i] points to student <names>[i] for all <count> students and writes the
+ * roster once. Points are clamped to 0 to 255. Nothing is changed when a student does not exist or
+ * a delta is outside -255 to 255. The points are changed on a copy of the points column of the
+ * current snapshot, written with the names of the shared roster and published as the next
+ * snapshot; concurrent decisions keep the snapshot they started with.
+ *
+ * @param roster handle of dh_open
+ * @param names names of students
+ * @param deltas points to add (negative to subtract), -255 to 255
+ * @param count number of students
+ * @return int DH_OK or error status
+ */
+int dh_update_points(dh_roster *roster, const char *const *names, const int *deltas, size_t count)
+{
+    if (roster == nullptr || (count > 0 && (names == nullptr || deltas == nullptr)))
+        return DH_ERROR_INVALID_ARGUMENT;
+    std::vector<uint32_t> studs(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (deltas[i] < -UINT8_MAX || deltas[i] > UINT8_MAX)
+            return DH_ERROR_INVALID_ARGUMENT;
+        studs[i] = names[i] ? roster->csvMan.getStudentIndex(names[i]) : NO_STUDENT;
+        if (studs[i] == NO_STUDENT)
+            return DH_ERROR_NOT_FOUND;
+    }
+
+    std::lock_guard<std::mutex> lock(roster->writer);
+    auto updated = std::make_unique<RosterSnapshot>();
+    updated->points = roster->snapshots.read()->points; // only the points column is copied
+    for (size_t i = 0; i < count; i++)
+    {
+        int points = updated->points[studs[i]] + deltas[i];
+        updated->points[studs[i]] = std::clamp(points, 0, UINT8_MAX);
+    }
+    if (!roster->csvMan.savePointsColumn(updated->points, updated->version))
+        return DH_ERROR_IO;
+    roster->snapshots.publish(std::move(updated));
+    return DH_OK;
+}
+
+/**
+ * @brief Returns points of student <name> in the current snapshot, DH_ERROR_NOT_FOUND when there
+ * is no such student
+ *
+ * @param roster handle of dh_open
+ * @param name name of student
+ * @return int
+ */
+int dh_get_points(dh_roster *roster, const char *name)
+{
+    if (roster == nullptr || name == nullptr)
+        return DH_ERROR_INVALID_ARGUMENT;
+    uint32_t stud = roster->csvMan.getStudentIndex(name);
+    if (stud == NO_STUDENT)
+        return DH_ERROR_NOT_FOUND;
+    return roster->snapshots.read()->points[stud];
+}
+
+/**
+ * @brief Releases a roster of dh_open
+ *
+ * @param roster handle of dh_open (may be NULL); no other call may use it anymore
+ */
+void dh_close(dh_roster *roster)
+{
+    delete roster;
+}
@@ -0,0 +1,56 @@
+#ifndef DECISION_API_H
+#define DECISION_API_H
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Status codes of the C API
+ */
+enum dh_status
+{
+    DH_OK = 0,
+    DH_ERROR_INVALID_ARGUMENT = -1, /* missing argument, invalid seminar group or delta of points */
+    DH_ERROR_NOT_FOUND = -2,        /* student not in roster */
+    DH_ERROR_NO_CANDIDATE = -3,     /* no student of the selection can be chosen */
+    DH_ERROR_BUFFER_TOO_SMALL = -4, /* name does not fit into the output buffer */
+    DH_ERROR_IO = -5                /* roster file could not be written */
+};
+
+/**
+ * @brief Loaded roster. A handle may be used by several threads at once (except dh_close): decisions
+ * and reading points take no lock and see the points of a completed update; updates are serialized.
+ */
+typedef struct dh_roster dh_roster;
+
+/**
+ * @brief Request of a decision. Students are given by name (unknown names are ignored) and/or by
+ * seminar group (XYINB-Z) or cohort year (XY). Rows are considered when <rows> is not NULL.
+ */
+typedef struct dh_request
+{
+    const char *const *names; /* students of the selection */
+    const int *rows;          /* seating row per name, NULL to ignore rows */
+    size_t name_count;
+    const char *const *groups; /* whole seminar groups or years */
+    size_t group_count;
+    const char *sem_group; /* current seminar group, NULL or "" if unknown */
+    uint8_t preferred_points;
+    int allow_repeater; /* 0 sorts out repeaters */
+} dh_request;
+
+dh_roster *dh_open(const char *csv_file);
+int dh_decide(dh_roster *roster, const dh_request *request, char *name_out, size_t name_out_size);
+int dh_update_points(dh_roster *roster, const char *const *names, const int *deltas, size_t count);
+int dh_get_points(dh_roster *roster, const char *name);
+void dh_close(dh_roster *roster);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
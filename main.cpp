@@ -1,30 +1,34 @@
 #include <iostream>
 #include "preprocessing.hpp"
 #include "DescisionPipeline.hpp"
+#include "CommandTrace.hpp"
+#include "commands.hpp"
+#include "Metrics.hpp"
+#include "CompactRoster.hpp"
 
 int main(int argc, char *argv[])
 {
     InputStruct input;
+    std::vector<std::string> args(argv + 1, argv + argc); // option processing alters argv
     if (preprocessing(argc, argv, &input) == -1)
         exit(-1);
+    // machine-readable result alone on stdout; messages go to stderr
+    int outputFd = STDOUT_FILENO;
+    if (recordsOutput(&input))
+    {
+        outputFd = dup(STDOUT_FILENO);
+        dup2(STDERR_FILENO, STDOUT_FILENO);
+    }
     DescisionPipeline decider(&input);
-    Student *chosenOne;
-    switch (input.state)
+    if (!input.traceFile.empty())
+        recordInvocation(input.traceFile, args, decider.getRosterVersion());
+    int result = runCommand(&input, &decider, outputFd);
+    if (input.stats)
     {
-    case decision:
-        chosenOne = decider.decideForStudent();
-        if (chosenOne)
-            std::cout << "The chosen student is: \t" << chosenOne->getName() << std::endl;
-        break;
-    case increment:
-        decider.incrementPointsOfSelection();
-        break;
-    case decrement:
-        decider.decrementPointsOfSelection();
-        break;
-    default:
-        puts("ERROR: command unhandled");
+        reportMetrics(input.statsFile);
+        decider.printRuleSelectivity(std::cerr);
+        printRosterFootprint(decider.getRoster(), std::cerr);
     }
 
-    return 0;
+    return result == -1 ? -1 : 0;
 }
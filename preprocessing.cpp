@@ -1,12 +1,23 @@
+#include <cctype>
+#include <charconv>
+#include <fcntl.h>
 #include <getopt.h>
 #include <iostream>
 #include <string>
 #include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "preprocessing.hpp"
 #include "InputStruct.hpp"
+#include "CohortKey.hpp"
+#include "OutputRecord.hpp"
 
-#define STUDENT_SEPARATOR ","
+#define SELECTION_SEPARATORS ",\n"
+#define SELECTION_CHUNK_SIZE 65536
 #define SEATINGROW_SEPARATOR ":"
+#define GROUP_PREFIX '@'
+#define EXCLUSION_PREFIX '!'
 
 static bool consider_row_flag = false; // flag for considering seating row
 static int allow_repeater_flag = 1;    // flag for allowing repeaters
@@ -21,19 +32,50 @@ void printHelp()
               << "Commands:\n"
               << "  decide      Decide for student of selection.\n"
               << "  add         Adds a point to a student's score.\n"
-              << "  sub         Subtracts a point of student's score.\n\n"
+              << "  sub         Subtracts a point of student's score.\n"
+              << "  rank        Lists students of selection in order of decision.\n"
+              << "  simulate    Simulates semesters of decisions and reports fairness of points and picks.\n"
+              << "  save-plan   Saves the selection as seating plan with the name given by --plan.\n\n"
               << "Options:\n"
               << "  -f, --file <filename>      Specify the CSV file. Default = 'student.csv'\n"
               << "  -g, --group <group>        Specify the seminar group.\n"
+              << "  -k, --top <count>          Specify the number of ranked students. Default = whole selection\n"
+              << "  -n, --count <count>        Specify the number of distinct students to decide for. Default = 1\n"
               << "  -p, --points <points>      Specify the preferred points. Default = 0\n"
               << "  -s, --selection <students> Specify the selection of students (comma-separated). Optional: Specify row by colon after name.\n"
+              << "                             @<group> selects a whole seminar group (e.g. @21INB-1) or year (e.g. @21),\n"
+              << "                             !<student> excludes a student. '-' reads the selection from stdin.\n"
+              << "  --selection-file <file>    Read the selection from a file (comma- or line-separated, '-' = stdin).\n"
+              << "  --plan <name>              Use the saved seating plan instead of a selection (-s may still exclude students).\n"
+              << "                             Plans are stored next to the CSV file and are invalid after students change.\n"
               << "  -h, --help                 Display this help text.\n"
               << "  -r, --row                  Consider seating rows.\n"
               << "  -v, --verbose              Enable verbose output.\n"
-              << "  --no-repeater              Sort out repeaters.\n\n"
+              << "  --no-repeater              Sort out repeaters.\n"
+              << "  --commit                   Add a point to every chosen student (one write of the CSV file).\n"
+              << "  --auto-resolve             Replace unknown names by the only similar name of the roster.\n"
+              << "  --attendance <probability> Specify the probability of a student to be present. Default = 1\n"
+              << "  --sessions <count>         Specify the sessions per simulated semester. Default = 30\n"
+              << "  --runs <count>             Specify the number of simulated semesters. Default = 1000\n"
+              << "  --threads <count>          Specify the threads of simulations and large decisions. Default = number of cores\n"
+              << "  --seed <seed>              Specify the seed of the simulation. Default = random\n"
+              << "  --output <format>          Print the result as text, json, tsv or binary (one record per call,\n"
+              << "                             messages go to stderr). simulate always prints text.\n"
+              << "  --log-json <logfile>       Append decision events as JSON lines to a file.\n"
+              << "  --trace <tracefile>        Append this call to a trace file (replay with Descision-Replay).\n"
+              << "  --stats[=<metricsfile>]    Print time and allocations per phase and memory of the roster. Optional: write metrics to file\n"
+              << "                             (JSON for '.json', Prometheus text format otherwise).\n\n"
               << "Examples:\n"
               << "  Descision-Helper decide -g 21INB-1 -p 1 -s MMusterfrau,MMustermann,JBinger\n"
               << "  Descision-Helper decide -s \"John:1,Jane:2\" -r -v\n"
+              << "  Descision-Helper decide -g 21INB-1 -s @21INB-1,@20INB-1,!MMustermann\n"
+              << "  Descision-Helper decide -n 3 --commit -s @21INB-1\n"
+              << "  Descision-Helper rank -k 3 -g 21INB-1 -s @21INB-1\n"
+              << "  Descision-Helper simulate -p 1 -n 2 --sessions 14 --attendance 0.8 -g 21INB-1 -s @21INB-1\n"
+              << "  Descision-Helper decide --output=json -s @21INB-1\n"
+              << "  Descision-Helper decide -r --selection-file seating.txt\n"
+              << "  Descision-Helper save-plan --plan room-A -r --selection-file seating.txt\n"
+              << "  Descision-Helper decide -g 21INB-1 --plan room-A -s !MMustermann\n"
               << "  Descision-Helper add --selection John\n"
               << "  Descision-Helper sub --file=data.csv --selection=John,Jane \n"
               << std::endl;
@@ -67,6 +109,12 @@ int preprocessing(int argc, char *argv[], InputStruct *input)
             input->state = increment;
         else if (decreaseArgAliases.find(command) != decreaseArgAliases.end()) // decrement students points
             input->state = decrement;
+        else if (rankArgAliases.find(command) != rankArgAliases.end()) // rank students
+            input->state = ranking;
+        else if (simulateArgAliases.find(command) != simulateArgAliases.end()) // simulate semesters
+            input->state = simulation;
+        else if (savePlanArgAliases.find(command) != savePlanArgAliases.end()) // save seating plan
+            input->state = planSaving;
         else
         {
             std::cout << "unknown command: \"" << command << "\"\n";
@@ -78,6 +126,18 @@ int preprocessing(int argc, char *argv[], InputStruct *input)
         puts("missing command");
         errorOccured = -1;
     }
+    // a plan is saved from a selection; decisions on a plan may only exclude students of it
+    bool selectsStudents = !input->studSelection.empty() || !input->groupSelection.empty();
+    if (errorOccured == 0 && input->state == planSaving && (input->planName == "" || !selectsStudents))
+    {
+        puts("Saving a seating plan needs its name (--plan <name>) and a selection of students.");
+        errorOccured = -1;
+    }
+    else if (errorOccured == 0 && input->state != planSaving && input->planName != "" && selectsStudents)
+    {
+        puts("With a seating plan the selection may only exclude students (!<student>).");
+        errorOccured = -1;
+    }
     // print hint for help when errors occured
     if (errorOccured == -1)
     {
@@ -98,7 +158,7 @@ int preprocessing(int argc, char *argv[], InputStruct *input)
  */
 int processOpts(int argc, char *argv[], InputStruct *input)
 {
-    const char *const short_opts = "f:g:p:s:hrv";
+    const char *const short_opts = "f:g:k:n:p:s:hrv";
     const option long_opts[] = {
         {"file", required_argument, nullptr, 'f'},
         {"group", required_argument, nullptr, 'g'},
@@ -109,15 +169,36 @@ int processOpts(int argc, char *argv[], InputStruct *input)
         {"seminar", required_argument, nullptr, 'g'},
         {"selection", required_argument, nullptr, 's'},
         {"students", required_argument, nullptr, 's'},
+        {"selection-file", required_argument, nullptr, 'F'},
+        {"plan", required_argument, nullptr, 'P'},
+        {"top", required_argument, nullptr, 'k'},
+        {"count", required_argument, nullptr, 'n'},
         // flags
         {"help", no_argument, nullptr, 'h'},
         {"row", no_argument, nullptr, 'r'},
         {"verbose", no_argument, nullptr, 'v'},
         {"no-repeater", no_argument, &allow_repeater_flag, 0},
+        {"trace", required_argument, nullptr, 'T'},
+        {"stats", optional_argument, nullptr, 'S'},
+        {"log-json", required_argument, nullptr, 'L'},
+        {"output", required_argument, nullptr, 'O'},
+        {"commit", no_argument, nullptr, 'C'},
+        {"auto-resolve", no_argument, nullptr, 'U'},
+        {"attendance", required_argument, nullptr, 'A'},
+        {"sessions", required_argument, nullptr, 'N'},
+        {"runs", required_argument, nullptr, 'R'},
+        {"threads", required_argument, nullptr, 'J'},
+        {"seed", required_argument, nullptr, 'D'},
         {0, 0, 0, 0}};
 
+    // reset parser state, so options can be processed more than once per process (e.g. replay)
+    optind = 0;
+    consider_row_flag = false;
+    allow_repeater_flag = 1;
+
     int c;
     char *selectionStr = nullptr;
+    char *selectionFile = nullptr;
     while (true)
     {
         int option_index = 0;
@@ -148,11 +229,27 @@ int processOpts(int argc, char *argv[], InputStruct *input)
             input->preferredPoints = atoi(optarg);
             break;
 
+        case 'k': // number of ranked students
+            input->rankCount = atoi(optarg);
+            break;
+
+        case 'n': // number of chosen students
+            input->pickCount = atoi(optarg) > 0 ? atoi(optarg) : 1;
+            break;
+
         case 's': // selection e.g. students
             // printf("option -s with value `%s'\n", optarg);
             selectionStr = optarg;
             break;
 
+        case 'F': // file of the selection
+            selectionFile = optarg;
+            break;
+
+        case 'P': // saved seating plan
+            input->planName = optarg;
+            break;
+
         case 'h': // help
             // puts("option -h\n");
             printHelp();
@@ -166,6 +263,49 @@ int processOpts(int argc, char *argv[], InputStruct *input)
             // puts("option -v\n");
             input->verbose = true;
             break;
+        case 'T': // trace file
+            input->traceFile = optarg;
+            break;
+        case 'C': // commit points of chosen students
+            input->commitPoints = true;
+            break;
+        case 'U': // resolve typos of names
+            input->autoResolve = true;
+            break;
+        case 'A': // attendance
+            input->attendance = atof(optarg);
+            break;
+        case 'N': // sessions per simulated semester
+            input->simSessions = atoi(optarg);
+            break;
+        case 'R': // simulated semesters
+            input->simRuns = atoi(optarg);
+            break;
+        case 'J': // threads of simulation and large decisions
+            input->threads = atoi(optarg);
+            break;
+        case 'D': // seed of simulation
+            input->simSeed = atoll(optarg);
+            break;
+        case 'O': // format of the result
+        {
+            int format = parseOutputFormat(optarg);
+            if (format == -1)
+            {
+                std::cout << "Output format \"" << optarg << "\" is not valid. It has to be text, json, tsv or binary.\n";
+                return -1;
+            }
+            input->output = (OutputFormat)format;
+            break;
+        }
+        case 'L': // event log as JSON lines
+            input->eventLogFile = optarg;
+            break;
+        case 'S': // stats
+            input->stats = true;
+            if (optarg)
+                input->statsFile = optarg;
+            break;
 
         case '?':
             break;
@@ -179,17 +319,37 @@ int processOpts(int argc, char *argv[], InputStruct *input)
     if (allow_repeater_flag == 0)
         input->allowRepeater = false;
 
+    // check if seminar group is valid
+    if (input->semGroup != "" && parseCohortKey(input->semGroup) == INVALID_COHORT)
+    {
+        std::cout << "Seminar group \"" << input->semGroup << "\" is not valid. It has to be in format XYINB-Z (e.g. 21INB-1).\n";
+        return -1;
+    }
+
+    // check if plan name is valid (plans are stored next to the CSV file)
+    if (input->planName.find('/') != std::string::npos)
+    {
+        std::cout << "Seating plan \"" << input->planName << "\" is not valid. Its name must not contain '/'.\n";
+        return -1;
+    }
+
     // check if selection is empty
-    if (selectionStr == nullptr)
+    if (selectionStr == nullptr && selectionFile == nullptr && input->planName == "")
     {
         puts("Selection of students is missing.");
         return -1;
     }
 
-    input->studSelection = processSelectionStr(selectionStr); // process selection of students
+    // entries go straight to the rows of the selection; the row flag is known after all options
+    if (selectionStr != nullptr && strcmp(selectionStr, "-") != 0 && processSelection(selectionStr, input) != 0)
+        return -1;
+    if (selectionStr != nullptr && strcmp(selectionStr, "-") == 0 && processSelectionFile("-", input) != 0)
+        return -1;
+    if (selectionFile != nullptr && processSelectionFile(selectionFile, input) != 0)
+        return -1;
 
-    // check if selection is valid
-    if (input->studSelection.empty())
+    // check if selection is valid (a saved plan may be given instead)
+    if (input->studSelection.empty() && input->groupSelection.empty() && input->planName == "")
     {
         std::cout << "Selection argument is not valid. It has to be \n 1 student:\t<studentName>";
         if (consider_row_flag)
@@ -201,6 +361,10 @@ int processOpts(int argc, char *argv[], InputStruct *input)
         if (consider_row_flag)
             std::cout << ":<seatingRow>";
         std::cout << ",...\n";
+        std::cout << "whole group:\t@<seminarGroup>";
+        if (consider_row_flag)
+            std::cout << ":<seatingRow>";
+        std::cout << " (e.g. @21INB-1) or @<year> (e.g. @21); exclude student by !<studentName>\n";
         return -1;
     }
 
@@ -208,94 +372,190 @@ int processOpts(int argc, char *argv[], InputStruct *input)
 }
 
 /**
- * @brief Splits the words in the vector to <string, int> by the delimiter. Returns vector with splitted words.
+ * @brief Adds one entry of a selection to <input>: @<group>[:<row>] selects a whole group,
+ * !<student> excludes a student, <student>[:<row>] selects a student. The row is only read when
+ * seating rows are considered. Blanks around the entry are ignored. Returns -1 when the group or
+ * the row is not valid, 0 otherwise.
  *
- * @param unsplitVector unsplitted vector
- * @param delimiter delimiter to split by
- * @return std::vector<std::string, int>
+ * @param entry entry of the selection
+ * @param input InputStruct to encapsulate the entry
+ * @return int
  */
-std::vector<std::pair<std::string, int>> splitElements(std::vector<std::string> unsplitVector, const char *delimiter)
+static int addSelectionEntry(std::string_view entry, InputStruct *input)
 {
-    std::vector<std::pair<std::string, int>> splitVector;
-    for (std::string unsplitWord : unsplitVector)
+    while (!entry.empty() && isspace((unsigned char)entry.front()))
+        entry.remove_prefix(1);
+    while (!entry.empty() && isspace((unsigned char)entry.back()))
+        entry.remove_suffix(1);
+    if (entry.empty())
+        return 0;
+    if (entry[0] == EXCLUSION_PREFIX)
     {
-        int delimiterPos = unsplitWord.find(delimiter); // get delimiter position
-        splitVector.push_back({
-            unsplitWord.substr(0, delimiterPos),                                                     // word before delimiter
-            std::stoi(unsplitWord.substr(delimiterPos + 1, unsplitWord.size() - (delimiterPos + 1))) // word after delimiter
-        });
+        input->excludedStuds.emplace(entry.substr(1));
+        return 0;
     }
-    return splitVector;
+
+    bool isGroup = entry[0] == GROUP_PREFIX;
+    if (isGroup)
+        entry.remove_prefix(1);
+    int row = 0;
+    size_t delimiterPos = entry.find(SEATINGROW_SEPARATOR);
+    // names keep their colon when seating rows are not considered, groups never do
+    if (delimiterPos != std::string_view::npos && (consider_row_flag || isGroup))
+    {
+        std::string_view rowStr = entry.substr(delimiterPos + 1);
+        entry = entry.substr(0, delimiterPos);
+        if (consider_row_flag)
+        {
+            auto [end, error] = std::from_chars(rowStr.data(), rowStr.data() + rowStr.size(), row);
+            if (error != std::errc() || end != rowStr.data() + rowStr.size() || row < 0)
+            {
+                std::cout << "Seating row \"" << rowStr << "\" of \"" << entry << "\" is not valid. It has to be a number >= 0.\n";
+                return -1;
+            }
+        }
+    }
+
+    if (!isGroup)
+    {
+        input->studSelection[row].emplace(entry);
+        return 0;
+    }
+    std::string group(entry);
+    if (parseCohortKey(group) == INVALID_COHORT && parseCohortYear(group) == INVALID_YEAR)
+    {
+        std::cout << "Group \"" << group << "\" is not valid. It has to be a seminar group XYINB-Z (e.g. @21INB-1) or a year XY (e.g. @21).\n";
+        return -1;
+    }
+    input->groupSelection[row].insert(std::move(group));
+    return 0;
 }
 
 /**
- * @brief Processes the given string of students. Returns map with students as set per row.
+ * @brief Adds the selection <selection> to <input> entry by entry. Entries are separated by commas
+ * or line breaks; see addSelectionEntry. Returns -1 at the first invalid entry, 0 otherwise.
  *
- * @param selectionStr
- * @return std::map<int, std::set<std::string>>
+ * @param selection selection, e.g. the argument of -s or the content of a selection file
+ * @param input InputStruct to encapsulate the selection
+ * @return int
  */
-std::map<int, std::set<std::string>> processSelectionStr(char *selectionStr)
+int processSelection(std::string_view selection, InputStruct *input)
 {
-    std::map<int, std::set<std::string>> selectionMap;
-    std::set<std::string> studsInRow;
-    std::vector<std::string> splitStuds = separateLine(selectionStr, STUDENT_SEPARATOR);
+    while (!selection.empty())
+    {
+        size_t end = selection.find_first_of(SELECTION_SEPARATORS);
+        if (addSelectionEntry(selection.substr(0, end), input) != 0)
+            return -1;
+        if (end == std::string_view::npos)
+            break;
+        selection.remove_prefix(end + 1);
+    }
+    return 0;
+}
 
-    // check if seating row has to be considered
-    if (consider_row_flag)
+/**
+ * @brief Adds the selection read from <fd> to <input> chunk by chunk. Only an entry crossing the
+ * end of a chunk is carried over to the next one. Returns -1 on read errors or invalid entries,
+ * 0 otherwise.
+ *
+ * @param fd file descriptor to read until its end
+ * @param input InputStruct to encapsulate the selection
+ * @return int
+ */
+static int processSelectionStream(int fd, InputStruct *input)
+{
+    std::string buffer;
+    size_t carried = 0; // bytes of an unfinished entry at the start of buffer
+    while (true)
     {
-        auto splittedVector = splitElements(splitStuds, SEATINGROW_SEPARATOR); // split names from seating row
-        int row = 0;
-        // insert students row by row to map
-        while (splittedVector.empty() == false)
+        buffer.resize(carried + SELECTION_CHUNK_SIZE);
+        ssize_t bytesRead = read(fd, buffer.data() + carried, SELECTION_CHUNK_SIZE);
+        if (bytesRead < 0 && errno == EINTR)
+            continue;
+        if (bytesRead < 0)
         {
-            studsInRow.clear(); // clear set
-            // collect all students with current row in set
-            for (auto it = splittedVector.begin(); it < splittedVector.end();)
-            {
-                if (it->second == row)
-                {
-                    studsInRow.insert(it->first);
-                    it = splittedVector.erase(it); // erase element
-                }
-                else
-                {
-                    it++;
-                }
-            }
-            selectionMap.insert({row, studsInRow});
-            row++;
+            std::cerr << "Error:\t" << "Could not read selection: " << strerror(errno) << std::endl;
+            return -1;
         }
-    }
-    else
-    {
-        // seating row not considered
-        for (std::string studName : splitStuds)
+        if (bytesRead == 0)
+            return processSelection(std::string_view(buffer.data(), carried), input);
+
+        std::string_view chunk(buffer.data(), carried + bytesRead);
+        size_t lastSeparator = chunk.find_last_of(SELECTION_SEPARATORS);
+        if (lastSeparator == std::string_view::npos)
         {
-            studsInRow.insert(studName);
+            carried = chunk.size();
+            continue;
         }
-        selectionMap.insert({0, studsInRow});
+        if (processSelection(chunk.substr(0, lastSeparator), input) != 0)
+            return -1;
+        carried = chunk.size() - (lastSeparator + 1);
+        memmove(buffer.data(), buffer.data() + lastSeparator + 1, carried);
     }
+}
 
-    return selectionMap;
+/**
+ * @brief Adds the selection of file <filename> to <input>; "-" reads standard input. Regular files
+ * are mapped into memory and parsed in place, other files (pipes, terminals) are read in chunks.
+ * Returns -1 when the file cannot be read or holds an invalid entry, 0 otherwise.
+ *
+ * @param filename selection file or "-"
+ * @param input InputStruct to encapsulate the selection
+ * @return int
+ */
+int processSelectionFile(std::string const &filename, InputStruct *input)
+{
+    if (filename == "-")
+        return processSelectionStream(STDIN_FILENO, input);
+
+    int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat fileStat;
+    if (fd < 0 || fstat(fd, &fileStat) != 0)
+    {
+        std::cerr << "Error:\t" << "Could not open selection file \"" << filename << "\": " << strerror(errno) << std::endl;
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    if (!S_ISREG(fileStat.st_mode) || fileStat.st_size == 0)
+    {
+        int result = processSelectionStream(fd, input);
+        close(fd);
+        return result;
+    }
+
+    void *mapped = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        std::cerr << "Error:\t" << "Could not map selection file \"" << filename << "\": " << strerror(errno) << std::endl;
+        return -1;
+    }
+    madvise(mapped, fileStat.st_size, MADV_SEQUENTIAL);
+    int result = processSelection(std::string_view((char const *)mapped, fileStat.st_size), input);
+    munmap(mapped, fileStat.st_size);
+    return result;
 }
 
 /**
- * @brief Separates given line by given delimiter and returns list of separated strings
+ * @brief Separates given line by given delimiter and returns views on the separated strings. The
+ * views refer to <line>; the list is allocated from <resource>.
  *
  * @param line string to separate
  * @param delimiter delimiter to separate by
- * @return vector<string>
+ * @param resource memory for the list
+ * @return std::pmr::vector<std::string_view>
  */
-std::vector<std::string> separateLine(char *line, const char *delimiter)
+std::pmr::vector<std::string_view> separateLine(char *line, const char *delimiter, std::pmr::memory_resource *resource)
 {
-    std::vector<std::string> words;        // vector to collect strings
-    char *token = strtok(line, delimiter); // char* until delimiter
+    std::pmr::vector<std::string_view> words(resource); // vector to collect strings
+    char *token = strtok(line, delimiter);               // char* until delimiter
     while (token != nullptr)
     {
-        std::string str = token; // string instead of char* for string methods (string cannot be nullptr)
-        if (str.back() == '\n')  // does str end with newline(LF)?
+        std::string_view str = token;
+        if (str.back() == '\n') // does str end with newline(LF)?
         {
-            str.pop_back(); // remove newline
+            str.remove_suffix(1); // remove newline
         }
         words.push_back(str);               // add word to list
         token = strtok(nullptr, delimiter); // next word
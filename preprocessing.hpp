@@ -1,6 +1,8 @@
 #pragma once
+#include <memory_resource>
 #include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "InputStruct.hpp"
 
@@ -19,8 +21,23 @@ const std::set<std::string> increaseArgAliases = {"add", "++"};
  */
 const std::set<std::string> decreaseArgAliases = {"sub", "--"};
 
+/**
+ * @brief Aliases for ranking argument
+ */
+const std::set<std::string> rankArgAliases = {"rank"};
+
+/**
+ * @brief Aliases for simulation argument
+ */
+const std::set<std::string> simulateArgAliases = {"simulate", "sim"};
+
+/**
+ * @brief Aliases for saving a seating plan
+ */
+const std::set<std::string> savePlanArgAliases = {"save-plan"};
+
 int preprocessing(int argc, char *argv[], InputStruct *input);
 int processOpts(int argc, char *argv[], InputStruct *input);
-std::map<int, std::set<std::string>> processSelectionStr(char *selectionStr);
-std::vector<std::string> separateLine(char *line, const char *delimiter);
-std::vector<std::pair<std::string, int>> splitElements(std::vector<std::string> unsplitVector, const char *delimiter);
+int processSelection(std::string_view selection, InputStruct *input);
+int processSelectionFile(std::string const &filename, InputStruct *input);
+std::pmr::vector<std::string_view> separateLine(char *line, const char *delimiter, std::pmr::memory_resource *resource);
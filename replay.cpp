@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <iostream>
+#include <unistd.h>
+#include "preprocessing.hpp"
+#include "DescisionPipeline.hpp"
+#include "DecisionCache.hpp"
+#include "CommandTrace.hpp"
+#include "commands.hpp"
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Result of replaying a trace once
+ */
+struct ReplayResult
+{
+    std::vector<double> latencies; // microseconds per call
+    double totalSeconds = 0;
+    size_t versionMismatches = 0;
+};
+
+/**
+ * @brief Prints the help-text in terminal. When this method is called, the program exits.
+ *
+ */
+void printReplayHelp()
+{
+    std::cout << "Usage: Descision-Replay <tracefile> [options]\n\n"
+              << "Replays recorded calls of Descision-Helper against a copy of the roster and reports latencies.\n\n"
+              << "Options:\n"
+              << "  -f, --file <filename>      Roster to replay against. Default = 'students.csv'\n"
+              << "  -n, --repeat <count>       Replay the trace <count> times. Default = 1\n"
+              << "  --cold                     Only replay with the roster evicted from page cache before each call.\n"
+              << "  --warm                     Only replay with the roster kept in page cache.\n"
+              << "  -h, --help                 Display this help text.\n"
+              << std::endl;
+    exit(1);
+}
+
+/**
+ * @brief Asks the kernel to drop cached pages of the given file
+ *
+ * @param filename file to evict
+ */
+void evictFromPageCache(std::string const &filename)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+        return;
+    fdatasync(fd); // dirty pages can not be dropped
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+/**
+ * @brief Replays all entries of the trace <repeat> times against <roster>.
+ * Output of the replayed calls is discarded.
+ *
+ * @param trace recorded calls
+ * @param roster roster file (will be changed by add/sub calls)
+ * @param repeat number of replays
+ * @param cold evict roster from page cache before each call
+ * @return ReplayResult
+ */
+ReplayResult replay(std::vector<TraceEntry> const &trace, std::string const &roster, int repeat, bool cold)
+{
+    ReplayResult result;
+    result.latencies.reserve(trace.size() * repeat);
+
+    // discard stdout of replayed calls
+    fflush(stdout);
+    std::cout.flush();
+    int savedStdout = dup(STDOUT_FILENO);
+    int devNull = open("/dev/null", O_WRONLY);
+    dup2(devNull, STDOUT_FILENO);
+    close(devNull);
+
+    for (int rep = 0; rep < repeat; rep++)
+    {
+        for (TraceEntry const &entry : trace)
+        {
+            // build writable argv, since option processing alters its arguments
+            std::vector<std::string> args = {"Descision-Helper"};
+            args.insert(args.end(), entry.args.begin(), entry.args.end());
+            args.push_back("--file=" + roster);
+            std::vector<char *> argv;
+            for (std::string &arg : args)
+                argv.push_back(&arg[0]);
+            argv.push_back(nullptr);
+
+            if (cold)
+                evictFromPageCache(roster);
+
+            // every recorded call ran in a process of its own, without cached decisions
+            DecisionCache::shared().clear();
+            auto start = std::chrono::steady_clock::now();
+            InputStruct input;
+            if (preprocessing(argv.size() - 1, argv.data(), &input) == 0)
+            {
+                DescisionPipeline decider(&input);
+                if (rep == 0 && decider.getRosterVersion() != entry.rosterVersion)
+                    result.versionMismatches++;
+                runCommand(&input, &decider);
+            }
+            std::cout.flush();
+            auto end = std::chrono::steady_clock::now();
+
+            double micros = std::chrono::duration<double, std::micro>(end - start).count();
+            result.latencies.push_back(micros);
+            result.totalSeconds += micros / 1e6;
+        }
+    }
+
+    fflush(stdout);
+    dup2(savedStdout, STDOUT_FILENO);
+    close(savedStdout);
+    return result;
+}
+
+/**
+ * @brief Prints latency percentiles and throughput of a replay
+ *
+ * @param name name of the replay variant
+ * @param result result of the replay
+ */
+void printResult(std::string const &name, ReplayResult result)
+{
+    if (result.latencies.empty())
+        return;
+    std::sort(result.latencies.begin(), result.latencies.end());
+    size_t n = result.latencies.size();
+    double p50 = result.latencies.at((n - 1) / 2);
+    double p99 = result.latencies.at((size_t)std::ceil(0.99 * n) - 1);
+    double max = result.latencies.back();
+
+    printf("%-6s calls: %zu\tp50: %.1f us\tp99: %.1f us\tmax: %.1f us\tthroughput: %.1f calls/s\n",
+           name.c_str(), n, p50, p99, max, n / result.totalSeconds);
+    if (result.versionMismatches > 0)
+        printf("       %zu calls were recorded against a different roster version\n", result.versionMismatches);
+}
+
+int main(int argc, char *argv[])
+{
+    std::string roster = CSVFILE;
+    int repeat = 1;
+    bool runCold = true;
+    bool runWarm = true;
+    std::string traceFile;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if ((arg == "-f" || arg == "--file") && i + 1 < argc)
+            roster = argv[++i];
+        else if ((arg == "-n" || arg == "--repeat") && i + 1 < argc)
+            repeat = std::max(1, atoi(argv[++i]));
+        else if (arg == "--cold")
+            runWarm = false;
+        else if (arg == "--warm")
+            runCold = false;
+        else if (arg == "-h" || arg == "--help")
+            printReplayHelp();
+        else
+            traceFile = arg;
+    }
+    if (traceFile.empty() || !fs::exists(roster))
+    {
+        puts("missing trace file or roster");
+        puts("To display help, use the -h or --help option.");
+        return -1;
+    }
+
+    std::vector<TraceEntry> trace = readTrace(traceFile);
+    // help calls would exit the replay
+    trace.erase(std::remove_if(trace.begin(), trace.end(), [](TraceEntry const &entry)
+                               { return std::find_if(entry.args.begin(), entry.args.end(), [](std::string const &arg)
+                                                     { return arg == "-h" || arg == "--help"; }) != entry.args.end(); }),
+                trace.end());
+    if (trace.empty())
+    {
+        puts("trace is empty");
+        return -1;
+    }
+
+    // replay against a copy, since add/sub change the roster
+    std::string replayRoster = roster + ".replay";
+    if (runWarm)
+    {
+        fs::copy_file(roster, replayRoster, fs::copy_options::overwrite_existing);
+        replay(trace, replayRoster, 1, false); // fill page cache
+        fs::copy_file(roster, replayRoster, fs::copy_options::overwrite_existing);
+        printResult("warm", replay(trace, replayRoster, repeat, false));
+    }
+    if (runCold)
+    {
+        fs::copy_file(roster, replayRoster, fs::copy_options::overwrite_existing);
+        printResult("cold", replay(trace, replayRoster, repeat, true));
+    }
+    fs::remove(replayRoster);
+
+    return 0;
+}
@@ -1,32 +1,31 @@
 #include <gtest/gtest.h>
+#include <chrono>
+#include <climits>
 #include <filesystem>
+#include <fstream>
 #include <random>
-#include "Student.hpp"
+#include <sstream>
+#include <thread>
 #include "CSVManager.hpp"
 #include "InputStruct.hpp"
 #include "DescisionPipeline.hpp"
+#include "CommandTrace.hpp"
+#include "Metrics.hpp"
+#include "Simulation.hpp"
+#include "RosterWatch.hpp"
+#include "CompactRoster.hpp"
+#include "OutputRecord.hpp"
+#include "ReferencePipeline.hpp"
+#include "DecisionCache.hpp"
+#include "decision_api.h"
+#include "RosterSnapshot.hpp"
+#include "preprocessing.hpp"
 
+using namespace std;
 namespace fs = std::filesystem;
 const char *mockfile = "mock_students.csv";
 
 /******************************* Fixtures ******************************************/
-class StudentTest : public testing::Test
-{
-protected:
-    Student *stud1;
-    Student *stud2;
-    Student *stud3;
-    Student *stud4;
-
-    StudentTest()
-    {
-        stud1 = new Student("MYstud1", "class1", (uint8_t)0);
-        stud2 = new Student("MYstud2", "class1", (uint8_t)1);
-        stud3 = new Student("MYstud3", "class2", (uint8_t)2);
-        stud4 = new Student("MYstud4", "class2", (uint8_t)4);
-    }
-};
-
 class CSVManagerTest : public testing::Test
 {
 protected:
@@ -99,130 +98,660 @@ protected:
     // Wrapper functions
     void rulePreferredPoints(DescisionPipeline *pipe)
     {
-        pipe->rulePreferredPoints(pipe->input->preferredPoints);
+        pipe->rulePreferredPoints<false>(pipe->input->preferredPoints);
     }
     std::set<string> closestLEQPointsStudents(uint8_t leqPoints, DescisionPipeline *pipe)
     {
-        return pipe->closestLEQPointsStudents(leqPoints, pipe->studPriorizing);
+        pipe->fillPointsHistogram();
+        if (pipe->closestLEQPoints<false>(leqPoints) == 0)
+            return {};
+        return studentsWithPoints(leqPoints, pipe);
     }
     std::set<string> closestGEQPointsStudents(uint8_t geqPoints, DescisionPipeline *pipe)
     {
-        return pipe->closestGEQPointsStudents(geqPoints, pipe->studPriorizing);
+        pipe->fillPointsHistogram();
+        if (pipe->closestGEQPoints<false>(geqPoints) == 0)
+            return {};
+        return studentsWithPoints(geqPoints, pipe);
+    }
+    std::set<string> studentsWithPoints(uint8_t points, DescisionPipeline *pipe)
+    {
+        std::set<string> studs;
+        for (Candidate const &cand : pipe->candidates)
+        {
+            if (pipe->csvMan.getPoints(cand.stud) == points)
+                studs.insert(std::string(pipe->csvMan.getName(cand.stud)));
+        }
+        return studs;
     }
     void rulePriorizeCorrectSemGroup(std::string semGroup, uint8_t priorizeValue, DescisionPipeline *pipe)
     {
-        pipe->rulePriorizeCorrectSemGroup(semGroup, priorizeValue);
+        pipe->rulePriorizeCorrectSemGroup<false>(parseCohortKey(semGroup), priorizeValue);
     }
     void rulePriorizeRepeaters(std::string semGroup, uint8_t priorizeValue, DescisionPipeline *pipe)
     {
-        pipe->rulePriorizeRepeaters(semGroup, priorizeValue);
+        pipe->rulePriorizeRepeaters<false>(parseCohortKey(semGroup), priorizeValue);
     }
     void ruleFurthestInFront(DescisionPipeline *pipe)
     {
-        pipe->ruleFurthestInFront();
+        pipe->ruleFurthestInFront<false>();
     }
     void removeLeastPriorized(DescisionPipeline *pipe)
     {
-        pipe->removeLeastPriorized();
+        pipe->removeLeastPriorized<false>();
     }
 
-    // Map Count
+    // Candidate Count
     int getRemainingSelectionSize(DescisionPipeline *pipe)
     {
-        return pipe->studPriorizing.size();
+        return pipe->candidates.size();
     }
     // See priorize value
     uint8_t getPriorizing(std::string studName, DescisionPipeline *pipe)
     {
-        return pipe->studPriorizing.at(studName);
+        uint32_t stud = pipe->csvMan.getStudentIndex(studName);
+        for (Candidate const &cand : pipe->candidates)
+        {
+            if (cand.stud == stud)
+                return cand.priority;
+        }
+        throw std::out_of_range("no candidate " + studName);
+    }
+    // set priorize values of candidates (roster position -> priorize value)
+    void setPriorizingMap(std::map<uint32_t, uint8_t> priorizeMap, DescisionPipeline *pipe)
+    {
+        pipe->candidates.clear();
+        for (auto const &pair : priorizeMap)
+            pipe->candidates.push_back({pair.first, 0, pair.second});
     }
-    // set priorizing map
-    void setPriorizingMap(std::map<std::string, uint8_t> priorizeMap, DescisionPipeline *pipe)
+    // get names of remaining candidates
+    std::set<std::string> getRemainingNames(DescisionPipeline *pipe)
     {
-        pipe->studPriorizing = priorizeMap;
+        std::set<std::string> names;
+        for (Candidate const &cand : pipe->candidates)
+            names.insert(std::string(pipe->csvMan.getName(cand.stud)));
+        return names;
     }
-    // get priorizing map
-    std::map<std::string, uint8_t> getPriorizingMap(DescisionPipeline *pipe)
+    // run filters in given order with student <name> unavailable; returns names of remaining candidates
+    std::set<std::string> runFiltersInOrder(DescisionPipeline *pipe, std::array<DecisionRule, FILTER_RULE_COUNT> order, std::string const &name)
     {
-        return pipe->studPriorizing;
+        pipe->filterOrder = order;
+        pipe->setUnavailable(pipe->csvMan.getStudentIndex(name), true);
+        pipe->resetCandidates();
+        pipe->runFilters<false, repeatersRemoved>();
+        pipe->setUnavailable(pipe->csvMan.getStudentIndex(name), false);
+        return getRemainingNames(pipe);
+    }
+    // get order of filters
+    std::array<DecisionRule, FILTER_RULE_COUNT> getFilterOrder(DescisionPipeline *pipe)
+    {
+        return pipe->filterOrder;
+    }
+    // get priorize values of candidates (roster position -> priorize value)
+    std::map<uint32_t, uint8_t> getPriorizingMap(DescisionPipeline *pipe)
+    {
+        std::map<uint32_t, uint8_t> priorizeMap;
+        for (Candidate const &cand : pipe->candidates)
+            priorizeMap.insert({cand.stud, cand.priority});
+        return priorizeMap;
     }
 };
 /***********************************************************************************/
 
-/* --- Testing class Student --- */
-// Testing basic get-methods
-TEST_F(StudentTest, GetAssertions)
-{
-    // Test getName
-    ASSERT_STREQ((stud1->getName()).c_str(), "MYstud1");
-    ASSERT_STREQ((stud2->getName()).c_str(), "MYstud2");
-    ASSERT_STREQ((stud3->getName()).c_str(), "MYstud3");
-    ASSERT_STREQ((stud4->getName()).c_str(), "MYstud4");
-    // Test getSemGroup
-    ASSERT_STREQ((stud1->getSemGroup()).c_str(), "class1");
-    ASSERT_STREQ((stud2->getSemGroup()).c_str(), "class1");
-    ASSERT_STREQ((stud3->getSemGroup()).c_str(), "class2");
-    ASSERT_STREQ((stud4->getSemGroup()).c_str(), "class2");
-    // Test getPoints
-    ASSERT_EQ(stud1->getPoints(), 0);
-    ASSERT_EQ(stud2->getPoints(), 1);
-    ASSERT_EQ(stud3->getPoints(), 2);
-    ASSERT_EQ(stud4->getPoints(), 4);
-    // Test getPointsAsStr
-    ASSERT_STREQ((stud1->getPointsAsStr()).c_str(), "0");
-    ASSERT_STREQ((stud2->getPointsAsStr()).c_str(), "1");
-    ASSERT_STREQ((stud3->getPointsAsStr()).c_str(), "2");
-    ASSERT_STREQ((stud4->getPointsAsStr()).c_str(), "4");
-}
-// Testing increment-method
-TEST_F(StudentTest, IncrementAssertions)
-{
-    // Old Points
-    int p1 = stud1->getPoints();
-    int p2 = stud2->getPoints();
-    int p3 = stud3->getPoints();
-    int p4 = stud4->getPoints();
-    // New points
-    stud1->incrementPoints();
-    stud2->incrementPoints();
-    stud3->incrementPoints();
-    stud4->incrementPoints();
-
-    ASSERT_EQ(stud1->getPoints(), p1 + 1);
-    ASSERT_EQ(stud2->getPoints(), p2 + 1);
-    ASSERT_EQ(stud3->getPoints(), p3 + 1);
-    ASSERT_EQ(stud4->getPoints(), p4 + 1);
-}
-// Testing decrement-method
-TEST_F(StudentTest, DecrementAssertions)
-{
-    // Old Points
-    int p1 = stud1->getPoints();
-    int p2 = stud2->getPoints();
-    int p3 = stud3->getPoints();
-    int p4 = stud4->getPoints();
-    // New Points
-    stud1->decrementPoints();
-    stud2->decrementPoints();
-    stud3->decrementPoints();
-    stud4->decrementPoints();
-
-    ASSERT_EQ(stud1->getPoints(), max(p1 - 1, 0));
-    ASSERT_EQ(stud2->getPoints(), max(p2 - 1, 0));
-    ASSERT_EQ(stud3->getPoints(), max(p3 - 1, 0));
-    ASSERT_EQ(stud4->getPoints(), max(p4 - 1, 0));
+/* --- Testing cohort keys --- */
+// Testing parseCohortKey
+TEST(CohortKeyTest, ParseAssertions)
+{
+    CohortKey key = parseCohortKey("21INB-1");
+    ASSERT_NE(key, INVALID_COHORT);
+    ASSERT_EQ(cohortYear(key), 21);
+    ASSERT_EQ(cohortGroup(key), 1);
+    ASSERT_EQ(cohortProgram(key), parseCohortKey("23INB-3") >> 8 & 0xffff); // same program
+    ASSERT_NE(cohortProgram(key), cohortProgram(parseCohortKey("21MIB-1")));
+    ASSERT_EQ(cohortGroup(parseCohortKey("22IB-255")), 255);
+    ASSERT_EQ(parseCohortKey("21INB-01"), key); // same group number
+
+    // invalid formats
+    ASSERT_EQ(parseCohortKey(""), INVALID_COHORT);
+    ASSERT_EQ(parseCohortKey("class1"), INVALID_COHORT);
+    ASSERT_EQ(parseCohortKey("2INB-1"), INVALID_COHORT);
+    ASSERT_EQ(parseCohortKey("21INB1"), INVALID_COHORT);
+    ASSERT_EQ(parseCohortKey("21INB-"), INVALID_COHORT);
+    ASSERT_EQ(parseCohortKey("21INBX-1"), INVALID_COHORT);
+    ASSERT_EQ(parseCohortKey("21inb-1"), INVALID_COHORT);
+    ASSERT_EQ(parseCohortKey("21INB-256"), INVALID_COHORT);
+    ASSERT_EQ(parseCohortKey("21INB-1 "), INVALID_COHORT);
+
+    // repeaters
+    ASSERT_TRUE(isRepeater(parseCohortKey("21INB-1"), parseCohortKey("22INB-1")));
+    ASSERT_FALSE(isRepeater(parseCohortKey("22INB-2"), parseCohortKey("22INB-1")));
+    ASSERT_FALSE(isRepeater(INVALID_COHORT, parseCohortKey("22INB-1")));
 }
 
 /* --- Testing class CSVManager --- */
-// Testing getStudent-method
+// Testing getStudentIndex-method
 TEST_F(CSVManagerTest, GetStudentAssertions)
 {
-    Student *stud1 = csvMan->getStudent("MMuster");
-    Student *stud2 = csvMan->getStudent("KReide");
-    Student *stud3 = csvMan->getStudent("noExisting");
-    ASSERT_NE(stud1, nullptr); // stud1 points to existing obj
-    ASSERT_NE(stud2, nullptr); // stud2 points to existing obj
-    ASSERT_EQ(stud3, nullptr); // stud3 points to nullptr (no stud with given name)
+    uint32_t stud1 = csvMan->getStudentIndex("MMuster");
+    uint32_t stud2 = csvMan->getStudentIndex("KReide");
+    uint32_t stud3 = csvMan->getStudentIndex("noExisting");
+    ASSERT_EQ(stud1, 0); // position of existing student
+    ASSERT_EQ(stud2, 1);
+    ASSERT_EQ(stud3, NO_STUDENT); // no stud with given name
+    ASSERT_EQ(csvMan->getName(stud2), "KReide");
+    ASSERT_EQ(csvMan->getSemGroup(stud2), "22INB-1");
+    ASSERT_EQ(csvMan->getPoints(stud2), 4);
+}
+// Testing getCohortKey-method
+TEST_F(CSVManagerTest, GetCohortKeyAssertions)
+{
+    ASSERT_EQ(csvMan->getCohortKey(csvMan->getStudentIndex("MMuster")), parseCohortKey("21INB-1"));
+    ASSERT_EQ(csvMan->getCohortKey(csvMan->getStudentIndex("RSalze")), parseCohortKey("22INB-2"));
+}
+// Testing getGroupMembers-method
+TEST_F(CSVManagerTest, GetGroupMembersAssertions)
+{
+    std::vector<uint32_t> group = {csvMan->getStudentIndex("JSubjekt"), csvMan->getStudentIndex("RSalze")};
+    std::vector<uint32_t> year = {csvMan->getStudentIndex("KReide"), csvMan->getStudentIndex("JSubjekt"),
+                                  csvMan->getStudentIndex("RSalze"), csvMan->getStudentIndex("FMeier")};
+    ASSERT_EQ(csvMan->getGroupMembers("22INB-2"), group); // whole seminar group in roster order
+    ASSERT_EQ(csvMan->getGroupMembers("22"), year);       // whole cohort year in roster order
+    ASSERT_TRUE(csvMan->getGroupMembers("22INB-3").empty());
+    ASSERT_TRUE(csvMan->getGroupMembers("noGroup").empty());
+
+    // invalid seminar groups are reported with one line per load
+    std::ofstream("test_students.csv", std::ios::app) << "AInvalid,INB-1,0\nBInvalid,22INB,0\nCInvalid,noGroup,0\n";
+    testing::internal::CaptureStderr();
+    CSVManager invalid("test_students.csv");
+    std::string warning = testing::internal::GetCapturedStderr();
+    ASSERT_EQ(std::count(warning.begin(), warning.end(), '\n'), 1);
+    ASSERT_NE(warning.find("3 students"), std::string::npos);
+    ASSERT_NE(warning.find("AInvalid"), std::string::npos);
+    ASSERT_EQ(invalid.getGroupMembers("22"), year);
+}
+
+// Testing getVersion-method
+TEST_F(CSVManagerTest, VersionAssertions)
+{
+    uint64_t loadedVersion = csvMan->getVersion();
+    ASSERT_EQ(CSVManager("test_students.csv").getVersion(), loadedVersion); // same content, same version
+
+    csvMan->incrementPoints("MMuster");
+    ASSERT_NE(csvMan->getVersion(), loadedVersion);
+    ASSERT_EQ(CSVManager("test_students.csv").getVersion(), csvMan->getVersion()); // written content matches
+
+    csvMan->decrementPoints("MMuster");
+    ASSERT_EQ(csvMan->getVersion(), loadedVersion);
+}
+// Testing loadRosters-method
+TEST_F(CSVManagerTest, LoadRostersAssertions)
+{
+    std::vector<CSVManager> rosters = CSVManager::loadRosters({mockfile, "test_students.csv", "noExisting.csv"});
+    ASSERT_EQ(rosters.size(), 3);
+    ASSERT_EQ(rosters[0].getStudentCount(), csvMan->getStudentCount());
+    ASSERT_EQ(rosters[1].getVersion(), csvMan->getVersion());
+    ASSERT_EQ(rosters[2].getStudentCount(), 0); // missing file is empty roster
+
+    // written content is read back unchanged
+    std::string content(3 << 20, 'x');
+    ASSERT_TRUE(writeFile("test_roster_io.txt", content));
+    FileContent file = readFile("test_roster_io.txt");
+    ASSERT_TRUE(file.found);
+    ASSERT_EQ(file.content, content);
+    ASSERT_FALSE(fs::exists("test_roster_io.txt.tmp")); // replaced by rename
+
+    // a failed write keeps the file unchanged
+    fs::create_directory("test_roster_io.txt.tmp");
+    ASSERT_FALSE(writeFile("test_roster_io.txt", "y"));
+    ASSERT_EQ(readFile("test_roster_io.txt").content, content);
+    fs::remove("test_roster_io.txt.tmp");
+    fs::remove("test_roster_io.txt");
+}
+// Testing reloadChanges-method
+TEST_F(CSVManagerTest, ReloadChangesAssertions)
+{
+    std::ofstream("test_students.csv") << "MMuster,21INB-1,3\n"   // points changed
+                                       << "KReide,22INB-2,4\n"    // seminar group changed
+                                       << "JSubjekt,22INB-2,1\n"
+                                       << "RSalze,22INB-2,1\n"
+                                       << "LNeu,22INB-1,0\n"      // renamed
+                                       << "CSchmidt,23INB-1,0\n"
+                                       << "PAnders,21INB-1,0\n";  // added
+    RosterDiff diff = csvMan->reloadChanges();
+    ASSERT_EQ(diff.changed, 3);
+    ASSERT_EQ(diff.added, 1);
+    ASSERT_EQ(diff.removed, 0);
+    ASSERT_EQ(csvMan->getPoints(csvMan->getStudentIndex("MMuster")), 3);
+    ASSERT_EQ(csvMan->getStudentIndex("FMeier"), NO_STUDENT);
+    ASSERT_EQ(csvMan->getStudentIndex("LNeu"), 4);
+    ASSERT_EQ(csvMan->getStudentIndex("PAnders"), 6);
+    std::vector<uint32_t> group = {1, 2, 3};
+    ASSERT_EQ(csvMan->getGroupMembers("22INB-2"), group);
+    group = {0, 6};
+    ASSERT_EQ(csvMan->getGroupMembers("21INB-1"), group);
+    ASSERT_EQ(csvMan->getVersion(), CSVManager("test_students.csv").getVersion());
+    ASSERT_EQ(csvMan->reloadChanges().changed, 0); // unchanged file
+
+    // removed rows
+    std::ofstream("test_students.csv") << "MMuster,21INB-1,3\n";
+    diff = csvMan->reloadChanges();
+    ASSERT_EQ(diff.removed, 6);
+    ASSERT_EQ(csvMan->getStudentCount(), 1);
+    ASSERT_EQ(csvMan->getStudentIndex("KReide"), NO_STUDENT);
+    ASSERT_TRUE(csvMan->getGroupMembers("22").empty());
+
+    // renamed rows shift the names behind them; duplicate names find their first student
+    std::ofstream("test_students.csv") << "MMuster,21INB-1,3\n"
+                                       << "AB,22INB-1,0\n"
+                                       << "CD,22INB-1,0\n"
+                                       << "AB,22INB-1,0\n";
+    csvMan->reloadChanges();
+    std::ofstream("test_students.csv") << "MMuster,21INB-1,3\n"
+                                       << "ABCDEFGH,22INB-1,0\n" // renamed, longer
+                                       << "CD,22INB-1,0\n"
+                                       << "AB,22INB-1,0\n";
+    diff = csvMan->reloadChanges();
+    ASSERT_EQ(diff.changed, 1);
+    ASSERT_EQ(csvMan->getName(2), "CD");
+    ASSERT_EQ(csvMan->getStudentIndex("ABCDEFGH"), 1);
+    ASSERT_EQ(csvMan->getStudentIndex("AB"), 3);
+    ASSERT_EQ(csvMan->getStudentIndex("CD"), 2);
+    ASSERT_EQ(csvMan->getVersion(), CSVManager("test_students.csv").getVersion());
+
+    // a changed file does not replace unsaved points
+    csvMan->adjustPoints(0, true);
+    std::ofstream("test_students.csv", std::ios::app) << "PAnders,21INB-1,0\n";
+    testing::internal::CaptureStderr();
+    diff = csvMan->reloadChanges();
+    testing::internal::GetCapturedStderr();
+    ASSERT_TRUE(diff.conflict);
+    ASSERT_EQ(diff.added, 0);
+    ASSERT_EQ(csvMan->getPoints(0), 4);
+    ASSERT_TRUE(csvMan->hasUnsavedPoints());
+}
+// Testing saveChanges-method when the file cannot be written
+TEST_F(CSVManagerTest, SaveChangesFailureAssertions)
+{
+    uint64_t version = csvMan->getVersion();
+    csvMan->adjustPoints(0, true);
+    fs::create_directory("test_students.csv.tmp"); // blocks the temporary file
+    testing::internal::CaptureStderr();
+    ASSERT_FALSE(csvMan->saveChanges());
+    testing::internal::GetCapturedStderr();
+    ASSERT_TRUE(csvMan->hasUnsavedPoints());
+    ASSERT_EQ(csvMan->getVersion(), version);
+
+    fs::remove("test_students.csv.tmp");
+    ASSERT_TRUE(csvMan->saveChanges());
+    ASSERT_FALSE(csvMan->hasUnsavedPoints());
+    ASSERT_NE(csvMan->getVersion(), version);
+}
+// Testing findSimilarNames-method
+TEST_F(CSVManagerTest, FindSimilarNamesAssertions)
+{
+    std::vector<NameMatch> matches = csvMan->findSimilarNames("mmustr", 3);
+    ASSERT_EQ(matches.size(), 1);
+    ASSERT_EQ(matches.front().stud, 0);
+    ASSERT_DOUBLE_EQ(matches.front().similarity, 0.5);
+    ASSERT_EQ(csvMan->findSimilarNames("Schmid", 3).front().stud, 5);
+    ASSERT_TRUE(csvMan->findSimilarNames("Xyz", 3).empty());
+    ASSERT_DOUBLE_EQ(csvMan->findSimilarNames("mmustr", 3).front().similarity, 0.5); // no counts left of earlier lookups
+
+    // index follows renamed students
+    std::ofstream("test_students.csv", std::ios::app) << "KReider,21INB-1,0\n";
+    csvMan->reloadChanges();
+    matches = csvMan->findSimilarNames("KReid", 3);
+    ASSERT_EQ(matches.size(), 2);
+    ASSERT_EQ(matches.at(0).stud, 1);
+    ASSERT_EQ(matches.at(1).stud, 6);
+}
+// Testing compact representation of the roster
+TEST_F(CSVManagerTest, CompactRosterAssertions)
+{
+    CompactRoster compact;
+    compact.append("MMuster", "21INB-1", 1);
+    compact.append("KReide", "22INB-1", 4);
+    compact.append("FMeier", "22INB-1", 2);
+    compact.append("CSchmidt", "bad", 0);
+    ASSERT_EQ(compact.getStudentCount(), 4);
+    ASSERT_EQ(compact.getGroupCount(), 3); // seminar groups are stored once
+    ASSERT_EQ(compact.getName(1), "KReide");
+    ASSERT_EQ(compact.getSemGroup(2), "22INB-1");
+    ASSERT_EQ(compact.getCohortKey(0), parseCohortKey("21INB-1"));
+    ASSERT_EQ(compact.getCohortKey(3), INVALID_COHORT);
+    compact.setPoints(1, 7);
+    ASSERT_EQ(compact.getPoints(1), 7);
+    ASSERT_EQ(compact.getPointsColumn(), std::vector<uint8_t>({1, 7, 2, 0}));
+
+    // the roster is stored in columns: less per student than a row object of two strings and the
+    // points, even without the heap blocks of the strings
+    std::string content;
+    for (int i = 0; i < 1000; i++)
+        content += "Student" + std::to_string(i) + ",2" + std::to_string(i % 4) + "INB-1,0\n";
+    CSVManager large("test_large.csv", FileContent{true, content});
+    ASSERT_EQ(large.getName(999), "Student999");
+    ASSERT_LT(large.memoryFootprint().studentBytes, 1000 * (2 * sizeof(std::string) + sizeof(uint64_t)));
+}
+// Testing RosterWatch
+TEST_F(CSVManagerTest, RosterWatchAssertions)
+{
+    RosterWatch watch(*csvMan);
+    ASSERT_FALSE(watch.changed());
+    csvMan->incrementPoints("MMuster"); // own writes leave nothing to apply
+    ASSERT_EQ(watch.refresh().changed, 0);
+
+    std::ofstream("test_students.csv", std::ios::app) << "PAnders,21INB-1,0\n";
+    ASSERT_TRUE(watch.changed());
+    ASSERT_EQ(watch.refresh().added, 1);
+    ASSERT_FALSE(watch.changed());
+    ASSERT_NE(csvMan->getStudentIndex("PAnders"), NO_STUDENT);
+
+    // malformed or missing files leave the roster as it is
+    std::ofstream("test_students.csv", std::ios::app) << "Broken,21INB-1,many\n";
+    ASSERT_TRUE(watch.changed());
+    RosterDiff diff = watch.refresh();
+    ASSERT_EQ(diff.changed + diff.added + diff.removed, 0);
+    ASSERT_EQ(csvMan->getStudentCount(), 7);
+    fs::remove("test_students.csv");
+    watch.refresh();
+    ASSERT_EQ(csvMan->getStudentCount(), 7);
+}
+
+/* --- Differential testing against the reference pipeline --- */
+// Testing decisions on random rosters and selections against the reference pipeline
+TEST(DifferentialTest, ReferencePipelineAssertions)
+{
+    std::mt19937 gen(20241019); // fixed, so failures can be reproduced
+    auto uniform = [&gen](int min, int max)
+    { return std::uniform_int_distribution<int>(min, max)(gen); };
+    std::chrono::nanoseconds optimizedTime(0);
+    std::chrono::nanoseconds referenceTime(0);
+    int decisions = 0;
+    // silence warnings about generated rosters and selections
+    std::ostringstream discarded;
+    std::streambuf *coutBuffer = std::cout.rdbuf(discarded.rdbuf());
+    std::streambuf *cerrBuffer = std::cerr.rdbuf(discarded.rdbuf());
+    struct RestoreStreams
+    {
+        std::streambuf *coutBuffer, *cerrBuffer;
+        ~RestoreStreams()
+        {
+            std::cout.rdbuf(coutBuffer);
+            std::cerr.rdbuf(cerrBuffer);
+        }
+    } restore{coutBuffer, cerrBuffer};
+
+    // mostly few years, groups and points, so rules have ties to break; sometimes the whole range
+    auto year = [&uniform]
+    {
+        int value = uniform(0, 9) == 0 ? uniform(0, 99) : uniform(19, 24);
+        return std::string(value < 10 ? "0" : "") + std::to_string(value);
+    };
+    auto points = [&uniform]
+    { return uniform(0, 9) == 0 ? uniform(0, 255) : uniform(0, 6); };
+    const std::vector<std::string> invalidGroups = {"invalid", "21inb-1", "21INB-", "2INB-1", "21INB-256", "21INBX-1"};
+    auto semGroup = [&]
+    {
+        if (uniform(0, 19) == 0)
+            return invalidGroups[uniform(0, invalidGroups.size() - 1)];
+        return year() + (uniform(0, 9) == 0 ? "IN" : "INB") + "-" + std::to_string(uniform(0, 9) == 0 ? uniform(0, 255) : uniform(1, 3));
+    };
+
+    for (int testCase = 0; testCase < 300; testCase++)
+    {
+        SCOPED_TRACE("case " + std::to_string(testCase));
+        int studCount = uniform(1, 200);
+        std::string content;
+        for (int i = 0; i < studCount; i++)
+            content += "S" + std::to_string(i) + "," + semGroup() + "," + std::to_string(points()) + "\n";
+        CSVManager roster("test_differential.csv", FileContent{true, content});
+
+        InputStruct input;
+        input.output = outputJSON; // record candidates per phase
+        if (uniform(0, 4) > 0)
+            input.semGroup = semGroup();
+        input.allowRepeater = input.semGroup.empty() || uniform(0, 1);
+        input.preferredPoints = uniform(0, 9) == 0 ? uniform(0, 255) : uniform(0, 7);
+        bool rows = uniform(0, 1);
+        for (int i = uniform(0, 20); i > 0; i--)
+            input.studSelection[rows ? uniform(1, 4) : 0].insert("S" + std::to_string(uniform(0, studCount - 1)));
+        for (int i = uniform(0, 2); i > 0; i--)
+        {
+            std::string semGroup = roster.getSemGroup(uniform(0, studCount - 1));
+            if (semGroup != "invalid")
+                input.groupSelection[rows ? uniform(1, 4) : 0].insert(uniform(0, 1) ? semGroup : semGroup.substr(0, 2));
+        }
+        for (int i = uniform(0, 3); i > 0; i--)
+            input.excludedStuds.insert("S" + std::to_string(uniform(0, studCount - 1)));
+        if (input.studSelection.empty() && input.groupSelection.empty())
+            input.studSelection[0].insert("S0");
+
+        ReferencePipeline reference(&input, roster);
+        DescisionPipeline pipe(&input, roster);
+        if (reference.onlyRepeatersSelected())
+        {
+            testing::internal::CaptureStdout();
+            ASSERT_EQ(pipe.decideForStudent(), NO_STUDENT);
+            testing::internal::GetCapturedStdout();
+            continue;
+        }
+        uint32_t seed = gen();
+        reference.seedRandom(seed);
+        pipe.seedRandom(seed);
+
+        auto start = std::chrono::steady_clock::now();
+        uint32_t chosen = pipe.decideForStudent();
+        auto optimizedEnd = std::chrono::steady_clock::now();
+        std::string referenceChosen = reference.decideForStudent();
+        referenceTime += std::chrono::steady_clock::now() - optimizedEnd;
+        optimizedTime += optimizedEnd - start;
+        decisions++;
+
+        // phases skipped by the pipeline end like the previous phase, so only recorded ones are compared
+        for (PhaseCandidates const &phase : pipe.getPhaseCandidates())
+        {
+            SCOPED_TRACE(getPhaseName(phase.phase));
+            std::vector<std::string> names;
+            for (uint32_t stud : phase.studs)
+                names.push_back(std::string(roster.getName(stud)));
+            auto expected = std::find_if(reference.getPhases().begin(), reference.getPhases().end(), [&phase](ReferencePhase const &refPhase)
+                                         { return refPhase.phase == phase.phase; });
+            ASSERT_NE(expected, reference.getPhases().end());
+            ASSERT_EQ(names, expected->names);
+        }
+        ASSERT_EQ(chosen != NO_STUDENT ? roster.getName(chosen) : "", referenceChosen);
+    }
+    ASSERT_GT(decisions, 200);
+    std::cout.rdbuf(coutBuffer);
+    std::cout << "reference pipeline / DescisionPipeline time per decision: "
+              << (double)referenceTime.count() / std::max<int64_t>(optimizedTime.count(), 1) << " (" << decisions << " decisions)\n";
+}
+
+/* --- Testing C API --- */
+// Testing decision and batch update of points through the C API
+TEST(DecisionApiTest, DecideUpdateAssertions)
+{
+    fs::copy(mockfile, "test_api.csv");
+    ASSERT_EQ(dh_open("no_such_roster.csv"), nullptr);
+    dh_roster *roster = dh_open("test_api.csv");
+    ASSERT_NE(roster, nullptr);
+
+    char name[16];
+    const char *names[] = {"MMuster", "KReide", "JSubjekt", "Unknown"};
+    dh_request request = {names, nullptr, 4, nullptr, 0, "22INB-2", 0, 0};
+    ASSERT_EQ(dh_decide(roster, &request, name, sizeof(name)), DH_OK);
+    ASSERT_STREQ(name, "JSubjekt");
+    ASSERT_EQ(dh_decide(roster, &request, name, 4), DH_ERROR_BUFFER_TOO_SMALL);
+    request.name_count = 1; // repeaters only
+    ASSERT_EQ(dh_decide(roster, &request, name, sizeof(name)), DH_ERROR_NO_CANDIDATE);
+    const char *groups[] = {"23"};
+    request = {nullptr, nullptr, 0, groups, 1, nullptr, 0, 1};
+    ASSERT_EQ(dh_decide(roster, &request, name, sizeof(name)), DH_OK);
+    ASSERT_STREQ(name, "CSchmidt");
+    request.sem_group = "INB";
+    ASSERT_EQ(dh_decide(roster, &request, name, sizeof(name)), DH_ERROR_INVALID_ARGUMENT);
+    ASSERT_EQ(dh_get_points(roster, "JSubjekt"), 1); // deciding does not change points
+    uint64_t cacheLookups = DecisionCache::shared().getHits() + DecisionCache::shared().getMisses();
+    request = {names, nullptr, 3, nullptr, 0, "22INB-2", 0, 1};
+    ASSERT_EQ(dh_decide(roster, &request, name, sizeof(name)), DH_OK);
+    ASSERT_EQ(DecisionCache::shared().getHits() + DecisionCache::shared().getMisses(), cacheLookups); // no lock taken
+
+    int deltas[] = {2, -1, 1, 1};
+    ASSERT_EQ(dh_update_points(roster, names, deltas, 4), DH_ERROR_NOT_FOUND); // nothing changed
+    ASSERT_EQ(dh_get_points(roster, "MMuster"), 1);
+    ASSERT_EQ(dh_update_points(roster, names, deltas, 3), DH_OK);
+    ASSERT_EQ(dh_get_points(roster, "MMuster"), 3);
+    ASSERT_EQ(dh_get_points(roster, "KReide"), 3);
+    ASSERT_EQ(dh_get_points(roster, "Unknown"), DH_ERROR_NOT_FOUND);
+
+    // deltas out of range are rejected, points are clamped without output
+    int outOfRange = INT_MIN;
+    ASSERT_EQ(dh_update_points(roster, names, &outOfRange, 1), DH_ERROR_INVALID_ARGUMENT);
+    int clampedDeltas[] = {255, -255, 3};
+    const char *const clampedNames[] = {"MMuster", "MMuster", "MMuster"};
+    testing::internal::CaptureStdout();
+    ASSERT_EQ(dh_update_points(roster, clampedNames, clampedDeltas, 1), DH_OK);
+    ASSERT_EQ(dh_get_points(roster, "MMuster"), 255);
+    ASSERT_EQ(dh_update_points(roster, clampedNames, clampedDeltas, 3), DH_OK); // 255, then 0, then 3
+    ASSERT_EQ(testing::internal::GetCapturedStdout(), "");
+    ASSERT_EQ(dh_get_points(roster, "MMuster"), 3);
+    dh_close(roster);
+
+    CSVManager written("test_api.csv");
+    fs::remove("test_api.csv");
+    ASSERT_EQ(written.getPoints(written.getStudentIndex("MMuster")), 3);
+    ASSERT_EQ(written.getPoints(written.getStudentIndex("JSubjekt")), 2);
+}
+
+// Testing concurrent decisions and reads during updates of points
+TEST(DecisionApiTest, ConcurrentSnapshotAssertions)
+{
+    fs::copy(mockfile, "test_api.csv", fs::copy_options::overwrite_existing);
+    dh_roster *roster = dh_open("test_api.csv");
+    ASSERT_NE(roster, nullptr);
+    const char *names[] = {"MMuster", "KReide"};
+    dh_request request = {names, nullptr, 2, nullptr, 0, nullptr, 1, 1};
+    const int updates = 50;
+
+    std::atomic<bool> done = false;
+    std::atomic<int> inconsistent = 0;
+    auto read = [&]()
+    {
+        int last = 1;
+        char chosen[16];
+        while (!done)
+        {
+            int points = dh_get_points(roster, "MMuster");
+            if (points < last || points > 1 + updates || dh_decide(roster, &request, chosen, sizeof(chosen)) != DH_OK)
+                inconsistent++;
+            last = points;
+        }
+    };
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++)
+        readers.emplace_back(read);
+    const int delta = 1;
+    for (int i = 0; i < updates; i++)
+        ASSERT_EQ(dh_update_points(roster, names, &delta, 1), DH_OK);
+    done = true;
+    for (std::thread &reader : readers)
+        reader.join();
+    ASSERT_EQ(inconsistent, 0);
+    ASSERT_EQ(dh_get_points(roster, "MMuster"), 1 + updates);
+    dh_close(roster);
+    CSVManager written("test_api.csv");
+    ASSERT_EQ(written.getPoints(written.getStudentIndex("MMuster")), 1 + updates);
+    fs::remove("test_api.csv");
+
+    // replaced snapshots live as long as their readers
+    RosterSnapshots snapshots({1, {3}});
+    {
+        SnapshotReader old = snapshots.read();
+        snapshots.publish(std::make_unique<RosterSnapshot>(RosterSnapshot{2, {4}}));
+        ASSERT_EQ(old->points[0], 3);
+        ASSERT_EQ(snapshots.read()->points[0], 4);
+        ASSERT_EQ(snapshots.retiredCount(), 1);
+    }
+    ASSERT_EQ(snapshots.retiredCount(), 0);
+}
+
+/* --- Testing command trace --- */
+// Testing recording and reading of trace
+TEST(CommandTraceTest, RecordReadAssertions)
+{
+    const char *traceFile = "test_trace.txt";
+    recordInvocation(traceFile, {"decide", "-s", "MMuster,KReide", "--trace", traceFile}, 0xabcdef);
+    recordInvocation(traceFile, {"add", "--trace=x", "-s", "MMuster"}, 42);
+
+    std::vector<TraceEntry> trace = readTrace(traceFile);
+    fs::remove(traceFile);
+    ASSERT_EQ(trace.size(), 2);
+    ASSERT_EQ(trace.at(0).rosterVersion, 0xabcdef);
+    ASSERT_EQ(trace.at(0).args, std::vector<std::string>({"decide", "-s", "MMuster,KReide"})); // trace option left out
+    ASSERT_EQ(trace.at(1).rosterVersion, 42);
+    ASSERT_EQ(trace.at(1).args, std::vector<std::string>({"add", "-s", "MMuster"}));
+    ASSERT_LE(trace.at(0).timestamp, trace.at(1).timestamp);
+}
+
+/* --- Testing preprocessing --- */
+// Testing selection read from a file
+TEST(PreprocessingTest, SelectionFileAssertions)
+{
+    const char *selectionFile = "test_selection.txt";
+    std::ofstream(selectionFile) << "MMuster:1\r\nKReide:0,JSubjekt:2\n@22INB-2:1\n!RSalze\n\n";
+    std::vector<std::string> args = {"Descision-Helper", "decide", "-r", "--selection-file", selectionFile, "-s", "FMeier:1"};
+    std::vector<char *> argv;
+    for (std::string &arg : args)
+        argv.push_back(arg.data());
+    InputStruct input;
+    int result = processOpts(argv.size(), argv.data(), &input);
+    ASSERT_EQ(result, 0);
+    ASSERT_EQ(input.studSelection.at(0), std::set<std::string>({"KReide"}));
+    ASSERT_EQ(input.studSelection.at(1), std::set<std::string>({"FMeier", "MMuster"}));
+    ASSERT_EQ(input.studSelection.at(2), std::set<std::string>({"JSubjekt"}));
+    ASSERT_EQ(input.groupSelection.at(1), std::set<std::string>({"22INB-2"}));
+    ASSERT_EQ(input.excludedStuds, std::set<std::string>({"RSalze"}));
+
+    // invalid row is reported instead of parsed partially
+    std::ofstream(selectionFile) << "MMuster:x\n";
+    InputStruct invalid;
+    ASSERT_EQ(processOpts(argv.size(), argv.data(), &invalid), -1);
+    fs::remove(selectionFile);
+}
+
+/* --- Testing simulation --- */
+// Testing fairness statistics
+TEST(SimulationTest, FairnessStatisticsAssertions)
+{
+    ASSERT_DOUBLE_EQ(giniCoefficient({2, 2, 2, 2}), 0);
+    ASSERT_DOUBLE_EQ(giniCoefficient({0, 0, 0, 4}), 0.75);
+    ASSERT_DOUBLE_EQ(jainIndex({2, 2, 2, 2}), 1);
+    ASSERT_DOUBLE_EQ(jainIndex({0, 0, 0, 4}), 0.25);
+    ASSERT_DOUBLE_EQ(standardDeviation({1, 3, 1, 3}), 1);
+}
+// Testing simulateSemesters
+TEST(SimulationTest, SimulateSemestersAssertions)
+{
+    CSVManager roster(mockfile);
+    InputStruct input;
+    input.studSelection = {{0, {"KReide", "FMeier", "JSubjekt", "RSalze", "CSchmidt", "MMuster", "noExistingOne"}}};
+    input.pickCount = 2;
+    input.simSessions = 6;
+    input.simRuns = 50;
+    input.simSeed = 42;
+    input.threads = 1;
+    SimulationResult single = simulateSemesters(&input, roster);
+    input.threads = 4;
+    SimulationResult parallel = simulateSemesters(&input, roster);
+
+    ASSERT_EQ(single.students.size(), 6);
+    ASSERT_EQ(single.picks, parallel.picks); // same streams regardless of threads
+    ASSERT_EQ(single.points, parallel.points);
+    double picks = 0;
+    for (double studPicks : single.picks)
+        picks += studPicks;
+    ASSERT_DOUBLE_EQ(picks, 12); // 2 picks in each of 6 sessions
+    ASSERT_EQ(roster.getPoints(roster.getStudentIndex("CSchmidt")), 0); // roster is not changed
 }
 
 /* --- Testing class DescisionPipeline --- */
@@ -385,15 +914,15 @@ TEST_F(DescisionPipelineTest, RuleFurthestInFrontAssertions)
 TEST_F(DescisionPipelineTest, RemoveLeastPriorizedAssertions)
 {
     uint8_t MAX_VALUE = (uint8_t)std::rand();
-    std::map<std::string, uint8_t> testMap;
-    std::map<std::string, uint8_t> checkMap;
+    std::map<uint32_t, uint8_t> testMap;
+    std::map<uint32_t, uint8_t> checkMap;
     // fill testMap
-    for (int i = 0; i < 100; i++)
+    for (uint32_t i = 0; i < 100; i++)
     {
         uint8_t randInt = (uint8_t)(std::rand() % MAX_VALUE + 1);
-        testMap.insert({std::to_string(i), randInt});
+        testMap.insert({i, randInt});
         if (randInt == MAX_VALUE) // if MAX_VALUE fill also in checkMap for later assertion
-            checkMap.insert({std::to_string(i), randInt});
+            checkMap.insert({i, randInt});
     }
     setPriorizingMap(testMap, pipe1);
 
@@ -417,7 +946,7 @@ TEST_F(DescisionPipelineTest, DecideForStudentAssertions)
         {1, {"JSubjekt", "RSalze"}},
         {2, {"CSchmidt", "MMuster"}}};
     pipe1 = new DescisionPipeline(input1);
-    studName = pipe1->decideForStudent()->getName();
+    studName = pipe1->getRoster().getName(pipe1->decideForStudent());
     ASSERT_EQ(studName, "CSchmidt");
 
     input1->preferredPoints = 1;         // prefer 1 point
@@ -430,7 +959,7 @@ TEST_F(DescisionPipelineTest, DecideForStudentAssertions)
         {1, {"JSubjekt", "RSalze"}},
         {2, {"MMuster"}}};
     pipe1 = new DescisionPipeline(input1);
-    studName = pipe1->decideForStudent()->getName();
+    studName = pipe1->getRoster().getName(pipe1->decideForStudent());
     ASSERT_EQ((studName == "JSubjekt") || (studName == "RSalze"), true);
 
     input1->preferredPoints = 1;         // prefer 1 points
@@ -443,7 +972,7 @@ TEST_F(DescisionPipelineTest, DecideForStudentAssertions)
         {1, {"JSubjekt", "RSalze"}},
         {2, {"MMuster"}}};
     pipe1 = new DescisionPipeline(input1);
-    studName = pipe1->decideForStudent()->getName();
+    studName = pipe1->getRoster().getName(pipe1->decideForStudent());
     ASSERT_EQ((studName == "JSubjekt") || (studName == "RSalze"), true);
 
     input1->preferredPoints = 1;         // prefer 1 points
@@ -456,6 +985,440 @@ TEST_F(DescisionPipelineTest, DecideForStudentAssertions)
         {1, {"JSubjekt", "RSalze"}},
         {2, {"MMuster"}}};
     pipe1 = new DescisionPipeline(input1);
-    studName = pipe1->decideForStudent()->getName();
+    studName = pipe1->getRoster().getName(pipe1->decideForStudent());
     ASSERT_EQ(studName, "MMuster");
 }
+// Testing metrics of decideForStudent
+TEST_F(DescisionPipelineTest, DecideForStudentMetricsAssertions)
+{
+    resetMetrics();
+    pipe1 = new DescisionPipeline(input1);
+    ASSERT_EQ(getPhaseMetric(phaseCSVLoad).calls, 1);
+    ASSERT_GT(getPhaseMetric(phaseCSVLoad).ioBytes, 0);
+    ASSERT_GT(getPhaseMetric(phaseCSVLoad).allocations, 0);
+    ASSERT_EQ(getPhaseMetric(phaseSelection).calls, 1);
+
+    pipe1->decideForStudent();
+    ASSERT_EQ(getPhaseMetric(phaseFirstSortingOut).calls, 1);
+    ASSERT_EQ(getPhaseMetric(phasePrioritization).calls, 1); // semGroup of input1 is set
+    ASSERT_EQ(getPhaseMetric(phaseSecondSortingOut).calls, 1);
+    ASSERT_EQ(getPhaseMetric(phaseFinalDecision).calls, 1);
+    ASSERT_EQ(getPhaseMetric(phaseCSVWrite).calls, 0);
+
+    std::ostringstream json;
+    writeMetricsJSON(json);
+    ASSERT_NE(json.str().find("{\"name\":\"final_decision\",\"calls\":1,"), std::string::npos);
+    std::ostringstream prometheus;
+    writeMetricsPrometheus(prometheus);
+    ASSERT_NE(prometheus.str().find("decision_helper_phase_calls_total{phase=\"csv_load\"} 1\n"), std::string::npos);
+
+    // metrics of other threads are added to the totals when they exit
+    std::thread worker([this]
+                       { DescisionPipeline(input1).decideForStudent(); });
+    worker.join();
+    ASSERT_EQ(getPhaseMetric(phaseFinalDecision).calls, 1);
+    ASSERT_EQ(getTotalPhaseMetric(phaseFinalDecision).calls, 2);
+    ASSERT_EQ(getTotalPhaseMetric(phaseCSVLoad).calls, 2);
+}
+// Testing skipping of rule stages after the decision is settled
+TEST_F(DescisionPipelineTest, DecideForStudentSkippedStagesAssertions)
+{
+    InputStruct input;
+    input.csvFile = "test_students.csv";
+    input.studSelection = {{0, {"CSchmidt"}}, {1, {"KReide", "MMuster"}}};
+    input.semGroup = "22INB-2";
+    input.allowRepeater = false;
+    DescisionPipeline pipe(&input);
+
+    resetMetrics();
+    ASSERT_EQ(pipe.getRoster().getName(pipe.decideForStudent()), "KReide"); // repeaters are sorted out in any case
+    ASSERT_EQ(getPhaseMetric(phaseFirstSortingOut).calls, 1);
+    ASSERT_EQ(getPhaseMetric(phaseFirstSortingOut).skippedStages, 1);
+    ASSERT_EQ(getPhaseMetric(phasePrioritization).skippedStages, 1);
+    ASSERT_EQ(getPhaseMetric(phaseSecondSortingOut).skippedStages, 2);
+    ASSERT_EQ(getPhaseMetric(phaseSecondSortingOut).calls, 0);
+}
+// Testing event log of decideForStudent
+TEST_F(DescisionPipelineTest, DecideForStudentEventLogAssertions)
+{
+    const char *logFile = "test_events.jsonl";
+    input1->eventLogFile = logFile;
+    input1->preferredPoints = 0;
+    input1->semGroup = "";
+    input1->studSelection = {
+        {0, {"KReide", "FMeier"}},
+        {1, {"JSubjekt", "RSalze"}},
+        {2, {"CSchmidt", "MMuster"}}};
+    pipe1 = new DescisionPipeline(input1);
+    ASSERT_EQ(pipe1->getRoster().getName(pipe1->decideForStudent()), "CSchmidt");
+    delete pipe1; // drains and closes log
+
+    std::ifstream logStream(logFile);
+    std::vector<std::string> lines;
+    std::string line;
+    while (getline(logStream, line))
+        lines.push_back(line);
+    fs::remove(logFile);
+
+    ASSERT_EQ(lines.front(), "{\"event\":\"selection_header\",\"value\":0,\"row\":0}");
+    ASSERT_NE(std::find(lines.begin(), lines.end(), "{\"event\":\"points_search\",\"value\":0,\"row\":1}"), lines.end());
+    ASSERT_NE(std::find(lines.begin(), lines.end(), "{\"event\":\"listed\",\"value\":0,\"row\":0,\"student\":\"CSchmidt\"}"), lines.end());
+    ASSERT_EQ(lines.back(), "{\"event\":\"phase\",\"value\":3,\"row\":0}");
+
+    // names are escaped, control characters included
+    std::string escaped;
+    appendJSONString(escaped, "A\"B\\C\tD\x01");
+    ASSERT_EQ(escaped, "\"A\\\"B\\\\C\\u0009D\\u0001\"");
+}
+// Testing decideForStudent does not allocate after setup
+TEST_F(DescisionPipelineTest, DecideForStudentAllocationAssertions)
+{
+    input1->studSelection = {
+        {0, {"KReide", "FMeier"}},
+        {1, {"JSubjekt", "RSalze"}},
+        {2, {"CSchmidt", "MMuster"}}};
+    for (bool allowRepeater : {true, false})
+    {
+        input1->allowRepeater = allowRepeater;
+        for (std::string semGroup : {"22INB-2", "21INB-1"})
+        {
+            input1->semGroup = semGroup;
+            for (uint8_t preferredPoints : {0, 1, 3, 200})
+            {
+                input1->preferredPoints = preferredPoints;
+                DescisionPipeline pipe(input1);
+                uint32_t firstChoice = pipe.decideForStudent(); // first decision after setup
+
+                uint64_t allocations = getAllocationCount();
+                for (int i = 0; i < 20; i++)
+                {
+                    uint32_t chosenOne = pipe.decideForStudent();
+                    ASSERT_EQ(pipe.getRoster().getPoints(chosenOne), pipe.getRoster().getPoints(firstChoice));
+                }
+                ASSERT_EQ(getAllocationCount(), allocations);
+            }
+        }
+    }
+}
+// Testing selection of whole groups with exclusions
+TEST_F(DescisionPipelineTest, GroupSelectionAssertions)
+{
+    InputStruct input;
+    input.csvFile = "test_students.csv";
+    input.studSelection = {{0, {"MMuster"}}};
+    input.groupSelection = {{0, {"22INB-2"}}, {1, {"22"}}};
+    input.excludedStuds = {"RSalze"};
+    DescisionPipeline pipe(&input);
+    std::set<std::string> expected = {"MMuster", "JSubjekt", "KReide", "FMeier"};
+    ASSERT_EQ(getRemainingNames(&pipe), expected);
+
+    // students of several groups keep their front row
+    pipe.decideForStudent();
+    expected = {"MMuster", "JSubjekt"};
+    ASSERT_EQ(getRemainingNames(&pipe), expected);
+}
+// Testing deciding on a saved seating plan
+TEST_F(DescisionPipelineTest, SeatingPlanAssertions)
+{
+    InputStruct input;
+    input.csvFile = "test_students.csv";
+    input.state = planSaving;
+    input.planName = "room";
+    input.studSelection = {{1, {"MMuster", "noExistingOne"}}, {2, {"KReide"}}};
+    input.groupSelection = {{3, {"22INB-2"}}};
+    std::string planFile = planFilename(input.csvFile, input.planName);
+    ASSERT_EQ(planFile, "test_students.room.plan");
+    DescisionPipeline saving(&input);
+    ASSERT_TRUE(saving.saveSeatingPlan(planFile));
+
+    // plan replaces the selection; exclusions still apply and changed points keep it valid
+    InputStruct planned;
+    planned.csvFile = "test_students.csv";
+    planned.state = decision;
+    planned.planName = "room";
+    planned.excludedStuds = {"RSalze"};
+    pipe1->incrementPointsOfSelection();
+    DescisionPipeline fromPlan(&planned);
+    std::set<std::string> expected = {"MMuster", "KReide", "JSubjekt"};
+    ASSERT_EQ(getRemainingNames(&fromPlan), expected);
+    ASSERT_EQ(fromPlan.getRoster().getName(fromPlan.decideForStudent()), "MMuster"); // furthest in front
+
+    // other students in the roster invalidate the plan
+    std::ofstream("test_students.csv", std::ios::app) << "XNeu,23INB-1,0\n";
+    DescisionPipeline stale(&planned);
+    ASSERT_TRUE(stale.getSelectedStudents().empty());
+    fs::remove(planFile);
+}
+// Testing resolving of typos in names
+TEST_F(DescisionPipelineTest, AutoResolveAssertions)
+{
+    InputStruct input;
+    input.csvFile = "test_students.csv";
+    input.studSelection = {{0, {"KReid", "jsubjekt", "RSalze"}}};
+    input.excludedStuds = {"RSalz"};
+    std::set<std::string> expected = {"RSalze"};
+    DescisionPipeline unresolved(&input);
+    ASSERT_EQ(getRemainingNames(&unresolved), expected);
+
+    input.autoResolve = true;
+    DescisionPipeline resolved(&input);
+    expected = {"KReide", "JSubjekt"};
+    ASSERT_EQ(getRemainingNames(&resolved), expected);
+}
+// Testing parallel rule passes against sequential ones
+TEST_F(DescisionPipelineTest, ParallelRulePassesAssertions)
+{
+    {
+        std::ofstream large("test_large.csv");
+        for (int i = 0; i < 20000; i++)
+            large << "Student" << i << "," << 21 + i % 3 << "INB-" << 1 + i % 2 << "," << i % 7 << "\n";
+    }
+    InputStruct input;
+    input.csvFile = "test_large.csv";
+    input.groupSelection = {{2, {"21"}}, {1, {"22INB-1"}}, {3, {"23"}}};
+    input.semGroup = "22INB-1";
+    input.preferredPoints = 3;
+    DescisionPipeline sequential(&input);
+    DescisionPipeline parallel(&input);
+    fs::remove("test_large.csv");
+    sequential.setParallelism(SIZE_MAX, 1);
+    parallel.setParallelism(0, 4);
+
+    rulePreferredPoints(&sequential);
+    rulePreferredPoints(&parallel);
+    ASSERT_EQ(getRemainingNames(&parallel), getRemainingNames(&sequential));
+    ASSERT_EQ(getRemainingNames(&parallel).size(), 2381); // students with 3 points
+
+    sequential.seedRandom(11);
+    parallel.seedRandom(11);
+    for (int i = 0; i < 5; i++)
+    {
+        ASSERT_EQ(parallel.getRoster().getName(parallel.decideForStudent()), sequential.getRoster().getName(sequential.decideForStudent()));
+        ASSERT_EQ(getRemainingNames(&parallel), getRemainingNames(&sequential));
+    }
+}
+// Testing machine-readable output of a decision
+TEST_F(DescisionPipelineTest, OutputRecordAssertions)
+{
+    InputStruct input;
+    input.csvFile = "test_students.csv";
+    input.studSelection = {{0, {"MMuster", "KReide", "JSubjekt"}}};
+    input.semGroup = "22INB-2";
+    input.output = outputJSON;
+    DescisionPipeline pipe(&input);
+    OutputRecord record;
+    record.command = decision;
+    record.chosen.push_back(pipe.decideForStudent());
+    record.phases = pipe.getPhaseCandidates();
+    record.changedPoints = {0};
+    ASSERT_EQ(formatRecord(record, pipe.getRoster(), outputJSON),
+              "{\"command\":\"decide\",\"chosen\":[\"JSubjekt\"],\"phases\":["
+              "{\"decision\":0,\"phase\":\"selection\",\"candidates\":[\"JSubjekt\",\"KReide\",\"MMuster\"]},"
+              "{\"decision\":0,\"phase\":\"first_sorting_out\",\"candidates\":[\"JSubjekt\",\"MMuster\"]},"
+              "{\"decision\":0,\"phase\":\"prioritization\",\"candidates\":[\"JSubjekt\",\"MMuster\"]},"
+              "{\"decision\":0,\"phase\":\"second_sorting_out\",\"candidates\":[\"JSubjekt\"]}],"
+              "\"points\":[{\"name\":\"MMuster\",\"points\":1}]}\n");
+
+    std::string tsv = formatRecord(record, pipe.getRoster(), outputTSV);
+    ASSERT_EQ(tsv.substr(0, 31), "command\tdecide\nchosen\tJSubjekt\n");
+    ASSERT_EQ(tsv.substr(tsv.size() - 18), "points\tMMuster\t1\n\n");
+
+    std::string binary = formatRecord(record, pipe.getRoster(), outputBinary);
+    ASSERT_EQ(binary.substr(0, 4), std::string("DHR\x02"));
+    uint32_t length = (uint8_t)binary[4] | (uint8_t)binary[5] << 8 | (uint8_t)binary[6] << 16 | (uint8_t)binary[7] << 24;
+    ASSERT_EQ(length, binary.size() - 8);
+    ASSERT_EQ(binary[8], decision);
+    ASSERT_EQ(binary.substr(9, 16), std::string("\x01\0\0\0\x08\0\0\0JSubjekt", 16)); // one chosen name
+
+    // nothing recorded for text output
+    input.output = outputText;
+    DescisionPipeline textPipe(&input);
+    textPipe.decideForStudent();
+    ASSERT_TRUE(textPipe.getPhaseCandidates().empty());
+}
+// Testing cache of the candidates before the random pick
+TEST_F(DescisionPipelineTest, DecisionCacheAssertions)
+{
+    DecisionCache &cache = DecisionCache::shared();
+    cache.clear();
+    uint64_t hits = cache.getHits();
+    uint64_t misses = cache.getMisses();
+    input1->studSelection = {{0, {"MMuster", "KReide", "JSubjekt", "RSalze"}}};
+
+    DescisionPipeline first(input1);
+    first.decideForStudent();
+    ASSERT_EQ(cache.getMisses(), misses + 1);
+    DescisionPipeline second(input1); // same request on same roster content
+    second.decideForStudent();
+    ASSERT_EQ(cache.getHits(), hits + 1);
+    ASSERT_EQ(getRemainingNames(&second), getRemainingNames(&first));
+
+    input1->preferredPoints = 4; // other request
+    second.decideForStudent();
+    ASSERT_EQ(cache.getMisses(), misses + 2);
+    std::set<std::string> expected = {"KReide"};
+    ASSERT_EQ(getRemainingNames(&second), expected);
+
+    // unsaved points bypass the cache, saved points are another roster version
+    second.decideForStudents(1); // first pick is a hit, then KReide has a point more
+    ASSERT_EQ(cache.getHits(), hits + 2);
+    second.decideForStudent();
+    ASSERT_EQ(cache.getHits() + cache.getMisses(), hits + misses + 4);
+    second.savePoints();
+    second.decideForStudent();
+    ASSERT_EQ(cache.getMisses(), misses + 3);
+
+    // a hit repeats the warning about repeaters that could not be sorted out
+    input1->semGroup = "";
+    input1->allowRepeater = false;
+    DescisionPipeline third(input1);
+    testing::internal::CaptureStdout();
+    third.decideForStudent();
+    third.decideForStudent();
+    std::string output = testing::internal::GetCapturedStdout();
+    ASSERT_EQ(cache.getHits(), hits + 3);
+    ASSERT_NE(output.find("WARNING - Could not sort out repeaters"), output.rfind("WARNING - Could not sort out repeaters"));
+
+    // entries are only returned for the request they were cached for
+    auto decision = std::make_shared<CachedDecision>();
+    decision->request.rosterVersion = 1;
+    cache.insert(decision);
+    DecisionRequest other = decision->request;
+    other.variant = 1;
+    ASSERT_NE(cache.find(decision->request), nullptr);
+    ASSERT_EQ(cache.find(other), nullptr);
+}
+// Testing decideForStudents-method
+TEST_F(DescisionPipelineTest, DecideForStudentsAssertions)
+{
+    InputStruct input;
+    input.csvFile = "test_students.csv";
+    input.studSelection = {{0, {"KReide", "FMeier", "JSubjekt", "RSalze", "CSchmidt"}}};
+    input.preferredPoints = 1;
+    DescisionPipeline pipe(&input);
+    uint64_t loadedVersion = pipe.getRosterVersion();
+
+    CSVManager const &roster = pipe.getRoster();
+    std::vector<uint32_t> chosen = pipe.decideForStudents(4);
+    ASSERT_EQ(chosen.size(), 4);
+    std::set<std::string> names;
+    for (uint32_t stud : chosen)
+        names.insert(std::string(roster.getName(stud)));
+    ASSERT_EQ(names.size(), 4);                       // distinct students
+    ASSERT_EQ(names.count("KReide"), 0);              // most points chosen last
+    ASSERT_EQ(roster.getName(chosen[2]), "CSchmidt"); // less points than preferred after preferred points
+    ASSERT_EQ(roster.getPoints(chosen[2]), 1);        // chosen students got a point
+    ASSERT_EQ(pipe.decideForStudents(9).size(), 5);
+
+    ASSERT_EQ(CSVManager("test_students.csv").getVersion(), loadedVersion); // nothing written yet
+    pipe.savePoints();
+    CSVManager saved("test_students.csv");
+    ASSERT_EQ(saved.getVersion(), pipe.getRosterVersion());
+    ASSERT_EQ(saved.getPoints(saved.getStudentIndex("CSchmidt")), 2);
+}
+// Testing decisions on a borrowed roster
+TEST_F(DescisionPipelineTest, BorrowedRosterAssertions)
+{
+    CSVManager roster("test_students.csv");
+    InputStruct input;
+    input.csvFile = "test_students.csv";
+    input.studSelection = {{0, {"KReide", "CSchmidt"}}};
+    DescisionPipeline pipe(&input, roster);
+    ASSERT_EQ(&pipe.getRoster(), &roster); // not copied
+
+    std::vector<uint32_t> chosen = pipe.decideForStudents(1);
+    ASSERT_EQ(roster.getName(chosen.at(0)), "CSchmidt");
+    ASSERT_EQ(pipe.getPoints(chosen[0]), 1); // point kept in the pipeline
+    ASSERT_EQ(roster.getPoints(chosen[0]), 0);
+    ASSERT_FALSE(roster.hasUnsavedPoints());
+    ASSERT_FALSE(pipe.savePoints());
+    ASSERT_EQ(CSVManager("test_students.csv").getVersion(), roster.getVersion());
+}
+// Testing rankStudents-method
+TEST_F(DescisionPipelineTest, RankStudentsAssertions)
+{
+    InputStruct input;
+    input.csvFile = "test_students.csv";
+    input.studSelection = {{0, {"KReide", "FMeier", "JSubjekt", "RSalze", "CSchmidt", "MMuster"}}};
+    input.semGroup = "22INB-2";
+    input.preferredPoints = 1;
+    DescisionPipeline pipe(&input);
+
+    CSVManager const &roster = pipe.getRoster();
+    std::vector<uint32_t> ranked = pipe.rankStudents(0);
+    ASSERT_EQ(ranked.size(), 6);
+    std::set<std::string> first = {std::string(roster.getName(ranked[0])), std::string(roster.getName(ranked[1]))};
+    std::set<std::string> expectedFirst = {"JSubjekt", "RSalze"}; // correct seminar group with preferred points
+    ASSERT_EQ(first, expectedFirst);
+    ASSERT_EQ(roster.getName(ranked[2]), "MMuster");  // repeater with preferred points
+    ASSERT_EQ(roster.getName(ranked[3]), "CSchmidt"); // less points than preferred before more points
+    ASSERT_EQ(roster.getName(ranked[4]), "FMeier");
+    ASSERT_EQ(roster.getName(ranked[5]), "KReide");
+    ASSERT_EQ(first.count(std::string(roster.getName(pipe.decideForStudent()))), 1); // decision picks one of the top ranked
+
+    ASSERT_EQ(pipe.rankStudents(3).size(), 3);
+    ASSERT_EQ(roster.getName(pipe.rankStudents(3)[2]), "MMuster");
+
+    // sorted out repeaters are not ranked
+    input.allowRepeater = false;
+    DescisionPipeline noRepeaterPipe(&input);
+    ASSERT_EQ(noRepeaterPipe.rankStudents(0).size(), 4);
+}
+// Testing selectivity counters and reordering of filters
+TEST_F(DescisionPipelineTest, FilterSelectivityAssertions)
+{
+    InputStruct input;
+    input.csvFile = "test_students.csv";
+    input.studSelection = {{0, {"KReide", "FMeier", "JSubjekt", "RSalze", "CSchmidt", "MMuster"}}};
+    input.semGroup = "22INB-2";
+    input.allowRepeater = false;
+    DescisionPipeline pipe(&input);
+
+    pipe.decideForStudent();
+    ASSERT_EQ(pipe.getRuleSelectivity(ruleRepeaters).evaluated, 6);
+    ASSERT_EQ(pipe.getRuleSelectivity(ruleRepeaters).removed, 2); // MMuster and CSchmidt
+    ASSERT_EQ(pipe.getRuleSelectivity(ruleUnavailable).evaluated, 0);
+    ASSERT_EQ(pipe.getRuleSelectivity(rulePoints).evaluated, 4);
+    std::array<DecisionRule, FILTER_RULE_COUNT> repeatersFirst = {ruleRepeaters, ruleUnavailable};
+    ASSERT_EQ(getFilterOrder(&pipe), repeatersFirst); // only filter removing students so far
+
+    // filters commute
+    std::array<DecisionRule, FILTER_RULE_COUNT> unavailableFirst = {ruleUnavailable, ruleRepeaters};
+    std::set<std::string> remaining = runFiltersInOrder(&pipe, unavailableFirst, "KReide");
+    ASSERT_EQ(runFiltersInOrder(&pipe, repeatersFirst, "KReide"), remaining);
+    std::set<std::string> expected = {"FMeier", "JSubjekt", "RSalze"};
+    ASSERT_EQ(remaining, expected);
+
+    // chosen students are filtered as unavailable
+    pipe.decideForStudents(3);
+    ASSERT_GT(pipe.getRuleSelectivity(ruleUnavailable).removed, 0);
+}
+// Testing all specialized variants of decideForStudent against each other
+TEST_F(DescisionPipelineTest, DecideForStudentVariantsAssertions)
+{
+    const char *logFile = "test_events.jsonl";
+    std::vector<std::map<int, std::set<std::string>>> selections = {
+        {{0, {"KReide", "FMeier", "JSubjekt", "RSalze", "CSchmidt", "MMuster"}}},
+        {{0, {"KReide", "FMeier"}}, {1, {"JSubjekt", "RSalze"}}, {2, {"CSchmidt", "MMuster"}}},
+        {{0, {"KReide"}}, {1, {"JSubjekt", "RSalze", "MMuster"}}}};
+    for (auto const &selection : selections)
+        for (bool allowRepeater : {true, false})
+            for (std::string semGroup : {"", "22INB-2", "21INB-1"})
+                for (uint8_t preferredPoints : {0, 1, 2, 5})
+                {
+                    InputStruct input;
+                    input.csvFile = "test_students.csv";
+                    input.studSelection = selection;
+                    input.allowRepeater = allowRepeater;
+                    input.semGroup = semGroup;
+                    input.preferredPoints = preferredPoints;
+                    DescisionPipeline plainPipe(&input);
+                    input.eventLogFile = logFile;
+                    DescisionPipeline loggingPipe(&input);
+
+                    plainPipe.decideForStudent();
+                    loggingPipe.decideForStudent();
+                    ASSERT_EQ(getRemainingNames(&plainPipe), getRemainingNames(&loggingPipe));
+                }
+    fs::remove(logFile);
+}